@@ -0,0 +1,1345 @@
+//
+// asm.cpp - Geração de código assembly x86-64 (System V, GNU as) a partir das TACs
+//
+// Convenções do código gerado:
+//  - variáveis (globais, locais e parâmetros, todas de escopo global na
+//    linguagem) ficam em .data/.bss com o prefixo v_; funções usam o prefixo f_
+//  - int ocupa 4 bytes, byte/char 1 byte, real é double e string é ponteiro
+//  - temporários ficam em registradores escolhidos por alocação linear
+//    (linear scan) sobre seus intervalos de vida; os que não couberem vão
+//    para slots de 8 bytes no quadro da função
+//  - cada TAC carrega os operandos em rax/rcx (inteiros) ou xmm0/xmm1 (reais),
+//    opera e guarda o resultado no local do destino
+//
+
+#include "asm.hpp"
+#include "cfg.hpp"
+#include "parser.tab.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// Representação de um valor em registrador
+typedef enum {
+    KIND_INT,     // inteiro de 64 bits (byte, int, char, boolean)
+    KIND_REAL,    // double
+    KIND_STRING   // ponteiro para a string
+} AsmKind;
+
+static FILE* asm_out = NULL;
+
+// Resumo da alocação de registradores de cada função em stderr (-stats)
+static bool asm_stats = false;
+
+// Intervalo de vida de um temporário na sequência de TACs da função
+typedef struct {
+    Symbol* temp;
+    int start;          // posição da primeira ocorrência
+    int end;            // posição da última ocorrência
+    bool real;          // valor em ponto flutuante (registrador xmm)
+    bool crossesCall;   // vivo durante um CALL, PRINT, READ ou SIMD_LOOP
+    int reg;            // registrador atribuído (-1: em memória)
+    int slot;           // slot no quadro, se estiver em memória
+} LiveInterval;
+
+// Registradores alocáveis. rax, rcx, rdx, xmm0 e xmm1 ficam livres para as
+// TACs; os preservados pela chamada (callee-saved) sobrevivem a chamadas,
+// os demais só servem a intervalos que não atravessam chamadas
+#define REG_CALLEE_SAVED 5
+#define REG_GPR 11
+#define REG_COUNT 25
+static const char* allocReg[REG_COUNT] = {
+    "%rbx", "%r12", "%r13", "%r14", "%r15",
+    "%rsi", "%rdi", "%r8", "%r9", "%r10", "%r11",
+    "%xmm2", "%xmm3", "%xmm4", "%xmm5", "%xmm6", "%xmm7", "%xmm8",
+    "%xmm9", "%xmm10", "%xmm11", "%xmm12", "%xmm13", "%xmm14", "%xmm15"
+};
+
+// Intervalos da função corrente; temp_interval indexa pelo número do
+// temporário e vale só se temp_owner for a função corrente
+static std::vector<LiveInterval> intervals;
+static std::vector<int> temp_interval;
+static std::vector<int> temp_owner;
+static int current_function = 0;
+
+// Elementos reservados para cada vetor (por id) e se algum acesso verifica
+// o índice (o tratador de erro só é gerado nesse caso)
+static std::vector<int> vector_length;
+static bool bounds_checked = false;
+
+// Vetores inicializados dentro de funções: a lista vai para .rodata e é
+// copiada a cada execução da declaração
+static std::vector<bool> vector_blob;
+
+// Laços vetorizados: numeração dos labels e se algum foi gerado (a detecção
+// de AVX2 e a flag .L_avx2 só são geradas nesse caso)
+static int simd_count = 0;
+static bool simd_used = false;
+static const char* simdBase[6] = {"%r8", "%r9", "%r10", "%r11", "%rsi", "%rdi"};
+
+// Registradores preservados empilhados pela função corrente (os slots ficam abaixo deles)
+static int saved_registers = 0;
+
+// Função corrente (NULL para a inicialização das globais)
+static Symbol* current_symbol = NULL;
+
+// Classe de cada ARG empilhado e ainda não consumido por um CALL
+static std::vector<AsmKind> pending_args;
+
+// Registradores usados para o primeiro (0) e o segundo (1) operando
+static const char* gpr64[2] = {"%rax", "%rcx"};
+static const char* gpr32[2] = {"%eax", "%ecx"};
+static const char* gpr8[2] = {"%al", "%cl"};
+static const char* xmm[2] = {"%xmm0", "%xmm1"};
+
+static bool isLiteral(Symbol* s) {
+    return s->type == LIT_INT || s->type == LIT_REAL || s->type == LIT_CHAR || s->type == LIT_STRING;
+}
+
+static bool isTemp(Symbol* s) {
+    return s->nature == SYMBOL_TEMP;
+}
+
+// Variável com armazenamento próprio na seção de dados
+static bool isVariable(Symbol* s) {
+    return s->type == TK_IDENTIFIER && s->isDeclared &&
+           (s->nature == SYMBOL_SCALAR || s->nature == SYMBOL_VECTOR);
+}
+
+// Tipo de dado de um operando (literais pelo token)
+static DataType operandType(Symbol* s) {
+    switch (s->type) {
+        case LIT_INT:    return DATATYPE_INT;
+        case LIT_REAL:   return DATATYPE_REAL;
+        case LIT_CHAR:   return DATATYPE_CHAR;
+        case LIT_STRING: return DATATYPE_STRING;
+        default:         return s->dataType;
+    }
+}
+
+static AsmKind kindOf(DataType type) {
+    if (type == DATATYPE_REAL) return KIND_REAL;
+    if (type == DATATYPE_STRING) return KIND_STRING;
+    return KIND_INT;
+}
+
+// Tamanho em memória de uma variável (ou de um elemento de vetor) do tipo
+static int sizeOf(DataType type) {
+    switch (type) {
+        case DATATYPE_BYTE:
+        case DATATYPE_CHAR:
+        case DATATYPE_BOOLEAN:
+            return 1;
+        case DATATYPE_REAL:
+        case DATATYPE_STRING:
+            return 8;
+        default:
+            return 4;
+    }
+}
+
+int asmElementSize(DataType type) {
+    return sizeOf(type);
+}
+
+// Valor inteiro de um literal (inteiros em base 10, char pelo código do caractere)
+static long literalInt(Symbol* s) {
+    if (s->type == LIT_CHAR) return (unsigned char)s->text[1];
+    if (s->type == LIT_REAL) return (long)strtod(s->text.c_str(), NULL);
+    return strtol(s->text.c_str(), NULL, 10);
+}
+
+// Local de uma variável ou temporário: registrador, slot no quadro ou memória global
+static std::string asmAddress(Symbol* s) {
+    if (isTemp(s)) {
+        LiveInterval* interval = &intervals[temp_interval[s->number]];
+        if (interval->reg >= 0) return allocReg[interval->reg];
+        return std::to_string(-8 * (saved_registers + interval->slot + 1)) + "(%rbp)";
+    }
+    return "v_" + s->text + "(%rip)";
+}
+
+// Converte o valor do registrador r entre representações
+static void asmConvert(AsmKind from, AsmKind to, int r) {
+    if (from == KIND_REAL && to != KIND_REAL)
+        fprintf(asm_out, "\tcvttsd2si %s, %s\n", xmm[r], gpr64[r]);
+    else if (from != KIND_REAL && to == KIND_REAL)
+        fprintf(asm_out, "\tcvtsi2sdq %s, %s\n", gpr64[r], xmm[r]);
+}
+
+// Carrega um operando no registrador r e devolve sua representação
+static AsmKind asmLoad(Symbol* s, int r) {
+    AsmKind kind = kindOf(operandType(s));
+
+    if (s->type == LIT_REAL) {
+        fprintf(asm_out, "\tmovsd .L_real%d(%%rip), %s\n", s->id, xmm[r]);
+    } else if (s->type == LIT_STRING) {
+        fprintf(asm_out, "\tleaq .L_str%d(%%rip), %s\n", s->id, gpr64[r]);
+    } else if (isLiteral(s)) {
+        long value = literalInt(s);
+        if (value == (int)value)
+            fprintf(asm_out, "\tmovq $%ld, %s\n", value, gpr64[r]);
+        else
+            fprintf(asm_out, "\tmovabsq $%ld, %s\n", value, gpr64[r]);
+    } else if (kind == KIND_REAL) {
+        fprintf(asm_out, "\tmovsd %s, %s\n", asmAddress(s).c_str(), xmm[r]);
+    } else if (isTemp(s) || kind == KIND_STRING) {
+        fprintf(asm_out, "\tmovq %s, %s\n", asmAddress(s).c_str(), gpr64[r]);
+    } else if (sizeOf(s->dataType) == 1) {
+        fprintf(asm_out, "\tmovzbq %s, %s\n", asmAddress(s).c_str(), gpr64[r]);
+    } else {
+        fprintf(asm_out, "\tmovslq %s, %s\n", asmAddress(s).c_str(), gpr64[r]);
+    }
+    return kind;
+}
+
+// Guarda o valor do registrador r no operando, convertendo para o seu tipo
+static void asmStore(Symbol* s, AsmKind kind, int r) {
+    AsmKind to = kindOf(s->dataType);
+    asmConvert(kind, to, r);
+
+    if (to == KIND_REAL)
+        fprintf(asm_out, "\tmovsd %s, %s\n", xmm[r], asmAddress(s).c_str());
+    else if (isTemp(s) || to == KIND_STRING)
+        fprintf(asm_out, "\tmovq %s, %s\n", gpr64[r], asmAddress(s).c_str());
+    else if (sizeOf(s->dataType) == 1)
+        fprintf(asm_out, "\tmovb %s, %s\n", gpr8[r], asmAddress(s).c_str());
+    else
+        fprintf(asm_out, "\tmovl %s, %s\n", gpr32[r], asmAddress(s).c_str());
+}
+
+// Cópia dos bits de uma variável global para rcx e de volta, sem conversão
+static void asmLoadRaw(Symbol* s) {
+    switch (sizeOf(s->dataType)) {
+        case 1:  fprintf(asm_out, "\tmovzbq %s, %%rcx\n", asmAddress(s).c_str()); break;
+        case 4:  fprintf(asm_out, "\tmovl %s, %%ecx\n", asmAddress(s).c_str()); break;
+        default: fprintf(asm_out, "\tmovq %s, %%rcx\n", asmAddress(s).c_str()); break;
+    }
+}
+
+static void asmStoreRaw(Symbol* s) {
+    switch (sizeOf(s->dataType)) {
+        case 1:  fprintf(asm_out, "\tmovb %%cl, %s\n", asmAddress(s).c_str()); break;
+        case 4:  fprintf(asm_out, "\tmovl %%ecx, %s\n", asmAddress(s).c_str()); break;
+        default: fprintf(asm_out, "\tmovq %%rcx, %s\n", asmAddress(s).c_str()); break;
+    }
+}
+
+// Chamada mantendo a pilha alinhada em 16 bytes: o quadro é múltiplo de 16,
+// então só os valores empilhados (pushed) podem desalinhá-la
+static void asmCallAligned(const char* target, int pushed) {
+    if (pushed % 2) fprintf(asm_out, "\tsubq $8, %%rsp\n");
+    fprintf(asm_out, "\tcall %s\n", target);
+    if (pushed % 2) fprintf(asm_out, "\taddq $8, %%rsp\n");
+}
+
+// Operações aritméticas e relacionais: res = op1 <op> op2
+static void asmBinary(TAC* tac) {
+    Symbol* res = (Symbol*)tac->res;
+    AsmKind kind1 = asmLoad((Symbol*)tac->op1, 0);
+    AsmKind kind2 = asmLoad((Symbol*)tac->op2, 1);
+
+    // Opera em ponto flutuante se algum operando for real ou se a divisão produz real
+    bool real = kind1 == KIND_REAL || kind2 == KIND_REAL ||
+                (tac->type == TAC_DIV && kindOf(res->dataType) == KIND_REAL);
+    if (real) {
+        asmConvert(kind1, KIND_REAL, 0);
+        asmConvert(kind2, KIND_REAL, 1);
+    }
+
+    switch (tac->type) {
+        case TAC_ADD: fprintf(asm_out, real ? "\taddsd %%xmm1, %%xmm0\n" : "\taddq %%rcx, %%rax\n"); break;
+        case TAC_SUB: fprintf(asm_out, real ? "\tsubsd %%xmm1, %%xmm0\n" : "\tsubq %%rcx, %%rax\n"); break;
+        case TAC_MUL: fprintf(asm_out, real ? "\tmulsd %%xmm1, %%xmm0\n" : "\timulq %%rcx, %%rax\n"); break;
+        case TAC_DIV: fprintf(asm_out, real ? "\tdivsd %%xmm1, %%xmm0\n" : "\tcqto\n\tidivq %%rcx\n"); break;
+        default: {
+            // Comparação: resultado booleano 0/1 em rax. Para reais, < e <= trocam
+            // os operandos para que a comparação com NaN resulte em falso
+            const char* set = "sete";
+            if (real) {
+                switch (tac->type) {
+                    case TAC_LT: fprintf(asm_out, "\tucomisd %%xmm0, %%xmm1\n"); set = "seta"; break;
+                    case TAC_LE: fprintf(asm_out, "\tucomisd %%xmm0, %%xmm1\n"); set = "setae"; break;
+                    case TAC_GT: fprintf(asm_out, "\tucomisd %%xmm1, %%xmm0\n"); set = "seta"; break;
+                    case TAC_GE: fprintf(asm_out, "\tucomisd %%xmm1, %%xmm0\n"); set = "setae"; break;
+                    case TAC_NE: fprintf(asm_out, "\tucomisd %%xmm1, %%xmm0\n"); set = "setne"; break;
+                    default:     fprintf(asm_out, "\tucomisd %%xmm1, %%xmm0\n"); set = "sete"; break;
+                }
+            } else {
+                fprintf(asm_out, "\tcmpq %%rcx, %%rax\n");
+                switch (tac->type) {
+                    case TAC_LT: set = "setl"; break;
+                    case TAC_LE: set = "setle"; break;
+                    case TAC_GT: set = "setg"; break;
+                    case TAC_GE: set = "setge"; break;
+                    case TAC_NE: set = "setne"; break;
+                    default:     set = "sete"; break;
+                }
+            }
+            fprintf(asm_out, "\t%s %%al\n", set);
+            if (real && tac->type == TAC_EQ) {
+                fprintf(asm_out, "\tsetnp %%dl\n\tandb %%dl, %%al\n");
+            } else if (real && tac->type == TAC_NE) {
+                fprintf(asm_out, "\tsetp %%dl\n\torb %%dl, %%al\n");
+            }
+            fprintf(asm_out, "\tmovzbq %%al, %%rax\n");
+            asmStore(res, KIND_INT, 0);
+            return;
+        }
+    }
+    asmStore(res, real ? KIND_REAL : KIND_INT, 0);
+}
+
+// Comparação com desvio: salta para o label quando a comparação é falsa, sem
+// materializar o booleano. Para reais os operandos são trocados como em
+// asmBinary, e NaN (comparação falsa) também salta
+static void asmCompareJump(TAC* tac) {
+    AsmKind kind1 = asmLoad((Symbol*)tac->op1, 0);
+    AsmKind kind2 = asmLoad((Symbol*)tac->op2, 1);
+    int label = ((Symbol*)tac->res)->number;
+
+    if (kind1 != KIND_REAL && kind2 != KIND_REAL) {
+        const char* jump;
+        switch (tac->type) {
+            case TAC_IFNLT: jump = "jge"; break;
+            case TAC_IFNLE: jump = "jg"; break;
+            case TAC_IFNGT: jump = "jle"; break;
+            case TAC_IFNGE: jump = "jl"; break;
+            case TAC_IFNEQ: jump = "jne"; break;
+            default:        jump = "je"; break;
+        }
+        fprintf(asm_out, "\tcmpq %%rcx, %%rax\n");
+        fprintf(asm_out, "\t%s .L_label%d\n", jump, label);
+        return;
+    }
+
+    asmConvert(kind1, KIND_REAL, 0);
+    asmConvert(kind2, KIND_REAL, 1);
+    switch (tac->type) {
+        case TAC_IFNLT:
+            fprintf(asm_out, "\tucomisd %%xmm0, %%xmm1\n\tjbe .L_label%d\n", label);
+            break;
+        case TAC_IFNLE:
+            fprintf(asm_out, "\tucomisd %%xmm0, %%xmm1\n\tjb .L_label%d\n", label);
+            break;
+        case TAC_IFNGT:
+            fprintf(asm_out, "\tucomisd %%xmm1, %%xmm0\n\tjbe .L_label%d\n", label);
+            break;
+        case TAC_IFNGE:
+            fprintf(asm_out, "\tucomisd %%xmm1, %%xmm0\n\tjb .L_label%d\n", label);
+            break;
+        case TAC_IFNEQ:
+            fprintf(asm_out, "\tucomisd %%xmm1, %%xmm0\n");
+            fprintf(asm_out, "\tjne .L_label%d\n\tjp .L_label%d\n", label, label);
+            break;
+        default:
+            // Igual e ordenado: o salto sobre o je trata o NaN (diferente)
+            fprintf(asm_out, "\tucomisd %%xmm1, %%xmm0\n");
+            fprintf(asm_out, "\tjp 1f\n\tje .L_label%d\n1:\n", label);
+            break;
+    }
+}
+
+// Endereço do vetor em rdx e índice em rcx. checked: índice fora de
+// 0..tamanho-1 desvia para o tratador de erro (uma comparação sem sinal
+// cobre os negativos); índices literais nos limites dispensam a verificação
+static void asmVectorAddress(Symbol* vector, Symbol* index, bool checked) {
+    AsmKind kind = asmLoad(index, 1);
+    asmConvert(kind, KIND_INT, 1);
+    int length = vector_length[vector->id];
+    if (checked && !(index->type == LIT_INT && literalInt(index) >= 0 && literalInt(index) < length)) {
+        fprintf(asm_out, "\tcmpq $%d, %%rcx\n", length);
+        fprintf(asm_out, "\tjae .L_bounds_error\n");
+        bounds_checked = true;
+    }
+    fprintf(asm_out, "\tleaq v_%s(%%rip), %%rdx\n", vector->text.c_str());
+}
+
+// res = vetor[índice]
+static void asmVectorIndex(TAC* tac) {
+    Symbol* vector = (Symbol*)tac->op1;
+    asmVectorAddress(vector, (Symbol*)tac->op2, !tac->inBounds);
+
+    AsmKind kind = kindOf(vector->dataType);
+    int size = sizeOf(vector->dataType);
+    if (kind == KIND_REAL)
+        fprintf(asm_out, "\tmovsd (%%rdx,%%rcx,8), %%xmm0\n");
+    else if (size == 8)
+        fprintf(asm_out, "\tmovq (%%rdx,%%rcx,8), %%rax\n");
+    else if (size == 1)
+        fprintf(asm_out, "\tmovzbq (%%rdx,%%rcx,1), %%rax\n");
+    else
+        fprintf(asm_out, "\tmovslq (%%rdx,%%rcx,4), %%rax\n");
+    asmStore((Symbol*)tac->res, kind, 0);
+}
+
+// vetor[índice] = valor
+static void asmVectorAssign(TAC* tac) {
+    Symbol* vector = (Symbol*)tac->res;
+    AsmKind kind = kindOf(vector->dataType);
+    int size = sizeOf(vector->dataType);
+
+    asmConvert(asmLoad((Symbol*)tac->op2, 0), kind, 0);
+    asmVectorAddress(vector, (Symbol*)tac->op1, !tac->inBounds);
+
+    if (kind == KIND_REAL)
+        fprintf(asm_out, "\tmovsd %%xmm0, (%%rdx,%%rcx,8)\n");
+    else if (size == 8)
+        fprintf(asm_out, "\tmovq %%rax, (%%rdx,%%rcx,8)\n");
+    else if (size == 1)
+        fprintf(asm_out, "\tmovb %%al, (%%rdx,%%rcx,1)\n");
+    else
+        fprintf(asm_out, "\tmovl %%eax, (%%rdx,%%rcx,4)\n");
+}
+
+// vetor[0..n-1] = lista de inicialização, copiada do .rodata. rsi e rdi
+// podem guardar temporários: são preservados em volta do rep movsb
+static void asmVectorInit(TAC* tac) {
+    Symbol* vector = (Symbol*)tac->res;
+    long bytes = (long)sizeOf(vector->dataType) * vector->initializer.size();
+    vector_blob[vector->id] = true;
+    fprintf(asm_out, "\tpushq %%rsi\n");
+    fprintf(asm_out, "\tpushq %%rdi\n");
+    fprintf(asm_out, "\tleaq .L_init%d(%%rip), %%rsi\n", vector->id);
+    fprintf(asm_out, "\tleaq v_%s(%%rip), %%rdi\n", vector->text.c_str());
+    fprintf(asm_out, "\tmovq $%ld, %%rcx\n", bytes);
+    fprintf(asm_out, "\trep movsb\n");
+    fprintf(asm_out, "\tpopq %%rdi\n");
+    fprintf(asm_out, "\tpopq %%rsi\n");
+}
+
+// Operandos de um laço vetorizado: um registrador xmm/ymm (a partir do 2)
+// para cada temporário do kernel e cada valor fixo, e um registrador de
+// base para cada vetor
+typedef struct {
+    int width;                      // bytes por elemento: 1, 4 ou 8 (real)
+    std::vector<Symbol*> regs;      // operando de cada registrador (índice + 2)
+    std::vector<Symbol*> fixed;     // valores fixos, replicados antes do laço
+    std::vector<Symbol*> vectors;   // vetor de cada registrador de base
+} SimdKernel;
+
+static int simdIndex(const std::vector<Symbol*>& list, Symbol* s) {
+    for (size_t k = 0; k < list.size(); k++)
+        if (list[k] == s) return (int)k;
+    return -1;
+}
+
+static std::string simdReg(const SimdKernel* kernel, Symbol* s, bool avx) {
+    return (avx ? "%ymm" : "%xmm") + std::to_string(simdIndex(kernel->regs, s) + 2);
+}
+
+static std::string simdElement(const SimdKernel* kernel, Symbol* vector) {
+    return std::string("(") + simdBase[simdIndex(kernel->vectors, vector)] + ",%rcx," + std::to_string(kernel->width) + ")";
+}
+
+// Replica o valor fixo s em todas as posições do seu registrador
+static void asmSimdBroadcast(const SimdKernel* kernel, Symbol* s, bool avx) {
+    std::string reg = simdReg(kernel, s, avx);
+    std::string low = simdReg(kernel, s, false);
+    if (kernel->width == 8) {
+        asmConvert(asmLoad(s, 0), KIND_REAL, 0);
+        if (avx) {
+            fprintf(asm_out, "\tvbroadcastsd %%xmm0, %s\n", reg.c_str());
+        } else {
+            fprintf(asm_out, "\tmovapd %%xmm0, %s\n", reg.c_str());
+            fprintf(asm_out, "\tunpcklpd %s, %s\n", reg.c_str(), reg.c_str());
+        }
+        return;
+    }
+    asmConvert(asmLoad(s, 0), KIND_INT, 0);
+    if (avx) {
+        fprintf(asm_out, "\tvmovd %%eax, %%xmm0\n");
+        fprintf(asm_out, "\t%s %%xmm0, %s\n", kernel->width == 1 ? "vpbroadcastb" : "vpbroadcastd", reg.c_str());
+        return;
+    }
+    fprintf(asm_out, "\tmovd %%eax, %s\n", reg.c_str());
+    if (kernel->width == 1) {
+        fprintf(asm_out, "\tpunpcklbw %s, %s\n", low.c_str(), low.c_str());
+        fprintf(asm_out, "\tpunpcklwd %s, %s\n", low.c_str(), low.c_str());
+    }
+    fprintf(asm_out, "\tpshufd $0, %s, %s\n", low.c_str(), low.c_str());
+}
+
+// Uma TAC do kernel sobre um bloco de elementos a partir do índice em rcx
+static void asmSimdStep(const SimdKernel* kernel, TAC* tac, bool avx) {
+    const char* v = avx ? "v" : "";
+    bool real = kernel->width == 8;
+    const char* move = real ? "movapd" : "movdqa";
+    const char* unaligned = real ? "movupd" : "movdqu";
+    Symbol* res = (Symbol*)tac->res;
+    Symbol* op1 = (Symbol*)tac->op1;
+    Symbol* op2 = (Symbol*)tac->op2;
+
+    switch (tac->type) {
+        case TAC_VECTOR_INDEX:
+            fprintf(asm_out, "\t%s%s %s, %s\n", v, unaligned, simdElement(kernel, op1).c_str(),
+                    simdReg(kernel, res, avx).c_str());
+            return;
+        case TAC_VECTOR_ASSIGN:
+            fprintf(asm_out, "\t%s%s %s, %s\n", v, unaligned, simdReg(kernel, op2, avx).c_str(),
+                    simdElement(kernel, res).c_str());
+            return;
+        case TAC_MOVE:
+            fprintf(asm_out, "\t%s%s %s, %s\n", v, move, simdReg(kernel, op1, avx).c_str(),
+                    simdReg(kernel, res, avx).c_str());
+            return;
+        default:
+            break;
+    }
+
+    std::string a = simdReg(kernel, op1, avx), b = simdReg(kernel, op2, avx), d = simdReg(kernel, res, avx);
+    if (!avx && !real && kernel->width == 4 && tac->type == TAC_MUL) {
+        // SSE2 não tem multiplicação de 32 bits: pmuludq multiplica as
+        // posições pares, as ímpares vão para as pares com psrlq, e os 32
+        // bits baixos dos produtos são intercalados de volta
+        fprintf(asm_out, "\tmovdqa %s, %s\n", a.c_str(), d.c_str());
+        fprintf(asm_out, "\tpmuludq %s, %s\n", b.c_str(), d.c_str());
+        fprintf(asm_out, "\tmovdqa %s, %%xmm0\n", a.c_str());
+        fprintf(asm_out, "\tpsrlq $32, %%xmm0\n");
+        fprintf(asm_out, "\tmovdqa %s, %%xmm1\n", b.c_str());
+        fprintf(asm_out, "\tpsrlq $32, %%xmm1\n");
+        fprintf(asm_out, "\tpmuludq %%xmm1, %%xmm0\n");
+        fprintf(asm_out, "\tpshufd $8, %s, %s\n", d.c_str(), d.c_str());
+        fprintf(asm_out, "\tpshufd $8, %%xmm0, %%xmm0\n");
+        fprintf(asm_out, "\tpunpckldq %%xmm0, %s\n", d.c_str());
+        return;
+    }
+
+    const char* op;
+    switch (tac->type) {
+        case TAC_ADD: op = real ? "addpd" : kernel->width == 4 ? "paddd" : "paddb"; break;
+        case TAC_SUB: op = real ? "subpd" : kernel->width == 4 ? "psubd" : "psubb"; break;
+        case TAC_MUL: op = real ? "mulpd" : "pmulld"; break;
+        default:      op = "divpd"; break;
+    }
+    if (avx) {
+        fprintf(asm_out, "\tv%s %s, %s, %s\n", op, b.c_str(), a.c_str(), d.c_str());
+    } else {
+        fprintf(asm_out, "\t%s %s, %s\n", move, a.c_str(), d.c_str());
+        fprintf(asm_out, "\t%s %s, %s\n", op, b.c_str(), d.c_str());
+    }
+}
+
+// Laço de blocos com registros de 16 (SSE2) ou 32 bytes (AVX2). Na entrada
+// rcx tem o índice inicial e rdx quantos elementos faltam; na saída rcx tem
+// o primeiro índice que sobrou para o laço escalar
+static void asmSimdPath(const SimdKernel* kernel, TAC* tac, int id, bool avx) {
+    const char* path = avx ? "avx" : "sse";
+    int lanes = (avx ? 32 : 16) / kernel->width;
+    fprintf(asm_out, "\tandq $%d, %%rdx\n", -lanes);
+    fprintf(asm_out, "\taddq %%rcx, %%rdx\n");
+    for (Symbol* s : kernel->fixed) asmSimdBroadcast(kernel, s, avx);
+    fprintf(asm_out, "\tcmpq %%rdx, %%rcx\n");
+    fprintf(asm_out, "\tjge .Lsimd%d_%s_done\n", id, path);
+    fprintf(asm_out, ".Lsimd%d_%s:\n", id, path);
+    for (TAC* step = tac->kernel; step; step = step->next) asmSimdStep(kernel, step, avx);
+    fprintf(asm_out, "\taddq $%d, %%rcx\n", lanes);
+    fprintf(asm_out, "\tcmpq %%rdx, %%rcx\n");
+    fprintf(asm_out, "\tjl .Lsimd%d_%s\n", id, path);
+    fprintf(asm_out, ".Lsimd%d_%s_done:\n", id, path);
+    if (avx) fprintf(asm_out, "\tvzeroupper\n");
+}
+
+// SIMD_LOOP i, n: roda o kernel em blocos de elementos de i até o último
+// múltiplo do bloco antes de n e guarda o índice seguinte em i. É tratado
+// como uma chamada pela alocação, então usa livremente os registradores que
+// não são preservados
+static void asmSimdLoop(TAC* tac) {
+    Symbol* iv = (Symbol*)tac->res;
+    int id = simd_count++;
+    simd_used = true;
+
+    SimdKernel kernel;
+    kernel.width = 0;
+    for (TAC* step = tac->kernel; step; step = step->next) {
+        Symbol* vector = step->type == TAC_VECTOR_INDEX ? (Symbol*)step->op1 :
+                         step->type == TAC_VECTOR_ASSIGN ? (Symbol*)step->res : NULL;
+        Symbol* operands[2] = {(Symbol*)step->op1, (Symbol*)step->op2};
+        if (vector) {
+            kernel.width = sizeOf(vector->dataType);
+            if (simdIndex(kernel.vectors, vector) < 0) kernel.vectors.push_back(vector);
+            operands[0] = step->type == TAC_VECTOR_ASSIGN ? (Symbol*)step->op2 : NULL;
+            operands[1] = NULL;
+        }
+        for (Symbol* s : operands) {
+            if (!s || simdIndex(kernel.regs, s) >= 0) continue;
+            kernel.regs.push_back(s);
+            kernel.fixed.push_back(s);
+        }
+        if (step->type != TAC_VECTOR_ASSIGN) kernel.regs.push_back((Symbol*)step->res);
+    }
+
+    asmConvert(asmLoad((Symbol*)tac->op1, 0), KIND_INT, 0);
+    asmLoad(iv, 1);
+    fprintf(asm_out, "\tmovq %%rax, %%rdx\n");
+    fprintf(asm_out, "\tsubq %%rcx, %%rdx\n");
+    fprintf(asm_out, "\tjle .Lsimd%d_end\n", id);
+    for (size_t k = 0; k < kernel.vectors.size(); k++)
+        fprintf(asm_out, "\tleaq v_%s(%%rip), %s\n", kernel.vectors[k]->text.c_str(), simdBase[k]);
+    fprintf(asm_out, "\tcmpb $0, .L_avx2(%%rip)\n");
+    fprintf(asm_out, "\tje .Lsimd%d_sse_path\n", id);
+    asmSimdPath(&kernel, tac, id, true);
+    fprintf(asm_out, "\tjmp .Lsimd%d_store\n", id);
+    fprintf(asm_out, ".Lsimd%d_sse_path:\n", id);
+    asmSimdPath(&kernel, tac, id, false);
+    fprintf(asm_out, ".Lsimd%d_store:\n", id);
+    asmStore(iv, KIND_INT, 1);
+    fprintf(asm_out, ".Lsimd%d_end:\n", id);
+}
+
+// res = &vetor[índice]
+static void asmVectorPointer(TAC* tac) {
+    Symbol* vector = (Symbol*)tac->op1;
+    asmVectorAddress(vector, (Symbol*)tac->op2, false);
+    fprintf(asm_out, "\tleaq (%%rdx,%%rcx,%d), %%rax\n", sizeOf(vector->dataType));
+    asmStore((Symbol*)tac->res, KIND_INT, 0);
+}
+
+// res = *ponteiro, com o tipo dos elementos do vetor em op2
+static void asmPointerLoad(TAC* tac) {
+    Symbol* vector = (Symbol*)tac->op2;
+    asmLoad((Symbol*)tac->op1, 1);
+
+    AsmKind kind = kindOf(vector->dataType);
+    int size = sizeOf(vector->dataType);
+    if (kind == KIND_REAL)
+        fprintf(asm_out, "\tmovsd (%%rcx), %%xmm0\n");
+    else if (size == 8)
+        fprintf(asm_out, "\tmovq (%%rcx), %%rax\n");
+    else if (size == 1)
+        fprintf(asm_out, "\tmovzbq (%%rcx), %%rax\n");
+    else
+        fprintf(asm_out, "\tmovslq (%%rcx), %%rax\n");
+    asmStore((Symbol*)tac->res, kind, 0);
+}
+
+// *ponteiro = valor, com o tipo dos elementos do vetor em op2
+static void asmPointerStore(TAC* tac) {
+    Symbol* vector = (Symbol*)tac->op2;
+    AsmKind kind = kindOf(vector->dataType);
+    int size = sizeOf(vector->dataType);
+
+    asmConvert(asmLoad((Symbol*)tac->op1, 0), kind, 0);
+    asmLoad((Symbol*)tac->res, 1);
+
+    if (kind == KIND_REAL)
+        fprintf(asm_out, "\tmovsd %%xmm0, (%%rcx)\n");
+    else if (size == 8)
+        fprintf(asm_out, "\tmovq %%rax, (%%rcx)\n");
+    else if (size == 1)
+        fprintf(asm_out, "\tmovb %%al, (%%rcx)\n");
+    else
+        fprintf(asm_out, "\tmovl %%eax, (%%rcx)\n");
+}
+
+// res = call função. Os ARGs já estão na pilha (o último no topo); cada um é
+// trocado pelo valor antigo do parâmetro correspondente, que é restaurado após
+// a chamada: como parâmetros são globais, isso mantém a recursão correta
+static void asmCall(TAC* tac) {
+    Symbol* func = (Symbol*)tac->op1;
+    int count = (int)func->parameters.size();
+    if (count > (int)pending_args.size()) count = (int)pending_args.size();
+
+    std::vector<Symbol*> params(count);
+    for (int i = 0; i < count; i++) {
+        Symbol* param = symbolFind(func->parameters[i].name.c_str());
+        AsmKind kind = pending_args[pending_args.size() - count + i];
+        int offset = 8 * (count - 1 - i);
+        params[i] = param;
+        if (!param) continue;
+
+        fprintf(asm_out, "\tmovq %d(%%rsp), %%rax\n", offset);
+        if (kind == KIND_REAL) fprintf(asm_out, "\tmovq %%rax, %%xmm0\n");
+        asmLoadRaw(param);
+        fprintf(asm_out, "\tmovq %%rcx, %d(%%rsp)\n", offset);
+        asmStore(param, kind, 0);
+    }
+    pending_args.resize(pending_args.size() - count);
+
+    std::string target = "f_" + func->text;
+    asmCallAligned(target.c_str(), (int)pending_args.size() + count);
+
+    for (int i = count - 1; i >= 0; i--) {
+        fprintf(asm_out, "\tpopq %%rcx\n");
+        if (params[i]) asmStoreRaw(params[i]);
+    }
+    asmStore((Symbol*)tac->res, kindOf(func->returnType), 0);
+}
+
+// print valor
+static void asmPrint(TAC* tac) {
+    Symbol* value = (Symbol*)tac->op1;
+    DataType type = operandType(value);
+    asmLoad(value, 0);
+
+    switch (type) {
+        case DATATYPE_REAL:
+            fprintf(asm_out, "\tleaq .L_fmt_real(%%rip), %%rdi\n");
+            fprintf(asm_out, "\tmovl $1, %%eax\n");
+            break;
+        case DATATYPE_STRING:
+            fprintf(asm_out, "\tmovq %%rax, %%rsi\n");
+            fprintf(asm_out, "\tleaq .L_fmt_string(%%rip), %%rdi\n");
+            fprintf(asm_out, "\txorl %%eax, %%eax\n");
+            break;
+        case DATATYPE_CHAR:
+            fprintf(asm_out, "\tmovq %%rax, %%rsi\n");
+            fprintf(asm_out, "\tleaq .L_fmt_char(%%rip), %%rdi\n");
+            fprintf(asm_out, "\txorl %%eax, %%eax\n");
+            break;
+        default:
+            fprintf(asm_out, "\tmovq %%rax, %%rsi\n");
+            fprintf(asm_out, "\tleaq .L_fmt_int(%%rip), %%rdi\n");
+            fprintf(asm_out, "\txorl %%eax, %%eax\n");
+            break;
+    }
+    asmCallAligned("printf@PLT", (int)pending_args.size());
+}
+
+// read variável: lê para um buffer e guarda com a conversão do tipo da variável
+static void asmRead(TAC* tac) {
+    Symbol* var = (Symbol*)tac->res;
+    const char* format;
+
+    switch (var->dataType) {
+        case DATATYPE_REAL:   format = ".L_fmt_read_real"; break;
+        case DATATYPE_CHAR:   format = ".L_fmt_read_char"; break;
+        case DATATYPE_STRING: return; // leitura de string não é suportada
+        default:              format = ".L_fmt_read_int"; break;
+    }
+
+    fprintf(asm_out, "\tmovq $0, .L_read_buffer(%%rip)\n");
+    fprintf(asm_out, "\tleaq .L_read_buffer(%%rip), %%rsi\n");
+    fprintf(asm_out, "\tleaq %s(%%rip), %%rdi\n", format);
+    fprintf(asm_out, "\txorl %%eax, %%eax\n");
+    asmCallAligned("scanf@PLT", (int)pending_args.size());
+
+    if (var->dataType == DATATYPE_REAL) {
+        fprintf(asm_out, "\tmovsd .L_read_buffer(%%rip), %%xmm0\n");
+        asmStore(var, KIND_REAL, 0);
+    } else if (var->dataType == DATATYPE_CHAR) {
+        fprintf(asm_out, "\tmovzbq .L_read_buffer(%%rip), %%rax\n");
+        asmStore(var, KIND_INT, 0);
+    } else {
+        fprintf(asm_out, "\tmovq .L_read_buffer(%%rip), %%rax\n");
+        asmStore(var, KIND_INT, 0);
+    }
+}
+
+// Gera uma TAC do corpo de uma função
+static void asmTac(TAC* tac) {
+    switch (tac->type) {
+        case TAC_SYMBOL:
+        case TAC_BEGINFUN:
+        case TAC_ENDFUN:
+            break;
+
+        case TAC_MOVE:
+            // Cópia entre temporários que compartilham o local não gera código
+            if (isTemp((Symbol*)tac->res) && isTemp((Symbol*)tac->op1) &&
+                asmAddress((Symbol*)tac->res) == asmAddress((Symbol*)tac->op1))
+                break;
+            asmStore((Symbol*)tac->res, asmLoad((Symbol*)tac->op1, 0), 0);
+            break;
+
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MUL:
+        case TAC_DIV:
+        case TAC_LT:
+        case TAC_GT:
+        case TAC_LE:
+        case TAC_GE:
+        case TAC_EQ:
+        case TAC_NE:
+            asmBinary(tac);
+            break;
+
+        case TAC_LABEL:
+            fprintf(asm_out, ".L_label%d:\n", ((Symbol*)tac->res)->number);
+            break;
+
+        case TAC_JUMP:
+            fprintf(asm_out, "\tjmp .L_label%d\n", ((Symbol*)tac->res)->number);
+            break;
+
+        case TAC_IFZ:
+            asmConvert(asmLoad((Symbol*)tac->op1, 0), KIND_INT, 0);
+            fprintf(asm_out, "\ttestq %%rax, %%rax\n");
+            fprintf(asm_out, "\tje .L_label%d\n", ((Symbol*)tac->res)->number);
+            break;
+
+        case TAC_IFNLT:
+        case TAC_IFNGT:
+        case TAC_IFNLE:
+        case TAC_IFNGE:
+        case TAC_IFNEQ:
+        case TAC_IFNNE:
+            asmCompareJump(tac);
+            break;
+
+        case TAC_ARG: {
+            AsmKind kind = asmLoad((Symbol*)tac->op1, 0);
+            if (kind == KIND_REAL) fprintf(asm_out, "\tmovq %%xmm0, %%rax\n");
+            fprintf(asm_out, "\tpushq %%rax\n");
+            pending_args.push_back(kind);
+            break;
+        }
+
+        case TAC_CALL:
+            asmCall(tac);
+            break;
+
+        case TAC_RET:
+            if (current_symbol) {
+                asmConvert(asmLoad((Symbol*)tac->op1, 0), kindOf(current_symbol->returnType), 0);
+            }
+            fprintf(asm_out, "\tjmp .L_return%d\n", current_function);
+            break;
+
+        case TAC_PRINT:
+            asmPrint(tac);
+            break;
+
+        case TAC_READ:
+            asmRead(tac);
+            break;
+
+        case TAC_VECTOR_INDEX:
+            asmVectorIndex(tac);
+            break;
+
+        case TAC_VECTOR_ASSIGN:
+            asmVectorAssign(tac);
+            break;
+
+        case TAC_VECTOR_ADDRESS:
+            asmVectorPointer(tac);
+            break;
+
+        case TAC_POINTER_LOAD:
+            asmPointerLoad(tac);
+            break;
+
+        case TAC_POINTER_STORE:
+            asmPointerStore(tac);
+            break;
+
+        case TAC_VECTOR_INIT:
+            asmVectorInit(tac);
+            break;
+
+        case TAC_SIMD_LOOP:
+            asmSimdLoop(tac);
+            break;
+    }
+}
+
+// Registrador livre compatível com o intervalo (-1 se não houver). Intervalos
+// sem chamadas preferem os registradores que não precisam ser preservados
+static int asmFreeRegister(const LiveInterval* interval, const bool* used) {
+    if (interval->real) {
+        if (interval->crossesCall) return -1;
+        for (int r = REG_GPR; r < REG_COUNT; r++)
+            if (!used[r]) return r;
+        return -1;
+    }
+    if (!interval->crossesCall) {
+        for (int r = REG_CALLEE_SAVED; r < REG_GPR; r++)
+            if (!used[r]) return r;
+    }
+    for (int r = 0; r < REG_CALLEE_SAVED; r++)
+        if (!used[r]) return r;
+    return -1;
+}
+
+static bool asmRegisterFits(const LiveInterval* interval, int reg) {
+    if (reg < 0) return false;
+    if (interval->real) return reg >= REG_GPR && !interval->crossesCall;
+    if (reg >= REG_GPR) return false;
+    return reg < REG_CALLEE_SAVED || !interval->crossesCall;
+}
+
+// Calcula os intervalos de vida dos temporários da função, junta as cópias
+// (TAC_MOVE entre temporários cujos intervalos só se tocam na cópia) e
+// distribui os registradores por alocação linear. Devolve o número de
+// slots do quadro e marca os registradores preservados usados
+static int asmAllocateRegisters(const std::vector<TAC*>& body, bool* calleeSavedUsed, int* coalesced, int* spilled) {
+    int count = (int)body.size();
+    intervals.clear();
+    *coalesced = 0;
+    *spilled = 0;
+
+    // Quantas chamadas há até cada posição
+    std::vector<int> calls(count + 1, 0);
+    for (int p = 0; p < count; p++) {
+        TacType type = body[p]->type;
+        bool call = type == TAC_CALL || type == TAC_PRINT || type == TAC_READ || type == TAC_SIMD_LOOP;
+        calls[p + 1] = calls[p] + (call ? 1 : 0);
+    }
+
+    // Intervalos: da primeira à última ocorrência
+    for (int p = 0; p < count; p++) {
+        TAC* tac = body[p];
+        void* operands[3] = {tac->res, tac->op1, tac->op2};
+        for (int k = 0; k < 3; k++) {
+            Symbol* s = (Symbol*)operands[k];
+            if (!s || !isTemp(s)) continue;
+            if (temp_owner[s->number] != current_function) {
+                LiveInterval interval;
+                interval.temp = s;
+                interval.start = p;
+                interval.end = p;
+                interval.real = kindOf(s->dataType) == KIND_REAL;
+                interval.crossesCall = false;
+                interval.reg = -1;
+                interval.slot = -1;
+                temp_owner[s->number] = current_function;
+                temp_interval[s->number] = (int)intervals.size();
+                intervals.push_back(interval);
+            }
+            intervals[temp_interval[s->number]].end = p;
+        }
+    }
+
+    // Um temporário vivo na entrada ou na saída de um bloco (por exemplo, na
+    // volta de um laço) tem o intervalo estendido até o início ou o fim do
+    // bloco. A vida de cada temporário sai de uma subida pelos predecessores
+    // a partir dos blocos que o leem antes de escrevê-lo, parando nos que o
+    // definem: o custo acompanha o trecho em que ele vive, e não o número de
+    // blocos vezes o de temporários
+    if (count > 0 && body[0]->type == TAC_BEGINFUN) {
+        CFG* cfg = cfgBuild(body[0]);
+        int blocks = (int)cfg->blocks.size();
+        std::vector<int> first(blocks), last(blocks);
+        std::vector<std::vector<int> > defBlocks(intervals.size());
+        std::vector<int> defStamp(intervals.size(), -1);
+        std::vector<std::pair<int, int> > exposed;  // (intervalo, bloco) lido antes de escrito
+
+        int position = 0;
+        for (const BasicBlock& block : cfg->blocks) {
+            first[block.id] = position;
+            for (TAC* tac = block.first; ; tac = tac->next) {
+                TacOperands ops = tacOperands(tac);
+                for (int k = 0; k < 3; k++) {
+                    Symbol* s = ops.use[k];
+                    if (!s || !isTemp(s)) continue;
+                    int i = temp_interval[s->number];
+                    if (defStamp[i] != block.id) exposed.push_back(std::make_pair(i, block.id));
+                }
+                Symbol* def = ops.def;
+                if (def && isTemp(def)) {
+                    int i = temp_interval[def->number];
+                    defStamp[i] = block.id;
+                    if (defBlocks[i].empty() || defBlocks[i].back() != block.id) defBlocks[i].push_back(block.id);
+                }
+                position++;
+                if (tac == block.last) break;
+            }
+            last[block.id] = position - 1;
+        }
+
+        std::sort(exposed.begin(), exposed.end());
+        std::vector<int> seen(blocks, -1);
+        std::vector<int> work;
+        for (size_t e = 0; e < exposed.size(); ) {
+            int i = exposed[e].first;
+            LiveInterval& interval = intervals[i];
+            work.clear();
+            for (; e < exposed.size() && exposed[e].first == i; e++) {
+                int b = exposed[e].second;
+                if (seen[b] != i) {
+                    seen[b] = i;
+                    work.push_back(b);
+                }
+            }
+            // work: blocos em que o temporário está vivo na entrada
+            while (!work.empty()) {
+                int b = work.back();
+                work.pop_back();
+                if (first[b] < interval.start) interval.start = first[b];
+                for (int p : cfg->blocks[b].pred) {
+                    if (last[p] > interval.end) interval.end = last[p];
+                    if (seen[p] == i) continue;
+                    if (std::find(defBlocks[i].begin(), defBlocks[i].end(), p) != defBlocks[i].end()) continue;
+                    seen[p] = i;
+                    work.push_back(p);
+                }
+            }
+        }
+
+        cfgFree(cfg);
+    }
+
+    // Cópias entre temporários: se o intervalo da origem termina na cópia e o
+    // do destino começa nela, os dois compartilham o mesmo local
+    for (int p = 0; p < count; p++) {
+        TAC* tac = body[p];
+        if (tac->type != TAC_MOVE) continue;
+        Symbol* dst = (Symbol*)tac->res;
+        Symbol* src = (Symbol*)tac->op1;
+        if (!isTemp(dst) || !isTemp(src)) continue;
+
+        int from = temp_interval[src->number];
+        int to = temp_interval[dst->number];
+        LiveInterval* source = &intervals[from];
+        LiveInterval* target = &intervals[to];
+        if (from == to || source->real != target->real || source->end != p || target->start != p) continue;
+
+        source->end = target->end;
+        target->start = -1;
+        temp_interval[dst->number] = from;
+        (*coalesced)++;
+    }
+
+    // Alocação linear: percorre os intervalos por início, liberando os que já
+    // terminaram; sem registrador livre, derrama o intervalo que termina mais tarde
+    std::vector<int> order;
+    for (int i = 0; i < (int)intervals.size(); i++) {
+        LiveInterval& interval = intervals[i];
+        if (interval.start < 0) continue;
+        interval.crossesCall = calls[interval.end] - calls[interval.start + 1] > 0;
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [](int a, int b) {
+        return intervals[a].start < intervals[b].start;
+    });
+
+    bool used[REG_COUNT] = {false};
+    std::vector<int> active;
+    int slots = 0;
+    for (int i : order) {
+        LiveInterval* interval = &intervals[i];
+
+        size_t kept = 0;
+        for (size_t k = 0; k < active.size(); k++) {
+            LiveInterval* other = &intervals[active[k]];
+            if (other->end <= interval->start) used[other->reg] = false;
+            else active[kept++] = active[k];
+        }
+        active.resize(kept);
+
+        int reg = asmFreeRegister(interval, used);
+        if (reg < 0) {
+            // Rouba o registrador do intervalo ativo compatível que termina mais tarde
+            int victim = -1;
+            for (size_t k = 0; k < active.size(); k++) {
+                LiveInterval* other = &intervals[active[k]];
+                if (asmRegisterFits(interval, other->reg) && other->end > interval->end &&
+                    (victim < 0 || other->end > intervals[active[victim]].end))
+                    victim = (int)k;
+            }
+            if (victim < 0) {
+                interval->slot = slots++;
+                (*spilled)++;
+                continue;
+            }
+            LiveInterval* other = &intervals[active[victim]];
+            reg = other->reg;
+            other->reg = -1;
+            other->slot = slots++;
+            (*spilled)++;
+            active.erase(active.begin() + victim);
+        }
+
+        interval->reg = reg;
+        used[reg] = true;
+        active.push_back(i);
+        if (reg < REG_CALLEE_SAVED) calleeSavedUsed[reg] = true;
+    }
+    return slots;
+}
+
+// Gera uma função (ou a inicialização das globais, se func for NULL)
+static void asmFunction(Symbol* func, const std::vector<TAC*>& body) {
+    current_function++;
+    current_symbol = func;
+    pending_args.clear();
+
+    bool calleeSaved[REG_CALLEE_SAVED] = {false};
+    int coalesced, spilled;
+    int slots = asmAllocateRegisters(body, calleeSaved, &coalesced, &spilled);
+
+    // Registradores preservados são empilhados logo abaixo de rbp; o quadro
+    // completa o alinhamento de 16 bytes
+    saved_registers = 0;
+    for (int r = 0; r < REG_CALLEE_SAVED; r++) {
+        if (calleeSaved[r]) saved_registers++;
+    }
+    int frame = (8 * (saved_registers + slots) + 15) / 16 * 16 - 8 * saved_registers;
+
+    if (asm_stats) {
+        fprintf(stderr, "Register allocation for '%s': %d temps, %d coalesced, %d spilled\n",
+                func ? func->text.c_str() : "global init", (int)intervals.size(), coalesced, spilled);
+    }
+
+    if (func) {
+        fprintf(asm_out, "\n\t.type f_%s, @function\n", func->text.c_str());
+        fprintf(asm_out, "f_%s:\n", func->text.c_str());
+    } else {
+        fprintf(asm_out, "\n.Lglobal_init:\n");
+    }
+    fprintf(asm_out, "\tpushq %%rbp\n");
+    fprintf(asm_out, "\tmovq %%rsp, %%rbp\n");
+    for (int r = 0; r < REG_CALLEE_SAVED; r++) {
+        if (calleeSaved[r]) fprintf(asm_out, "\tpushq %s\n", allocReg[r]);
+    }
+    if (frame) fprintf(asm_out, "\tsubq $%d, %%rsp\n", frame);
+
+    for (TAC* tac : body) {
+        asmTac(tac);
+    }
+
+    // Sem return explícito a função devolve zero
+    fprintf(asm_out, "\txorl %%eax, %%eax\n");
+    fprintf(asm_out, "\tpxor %%xmm0, %%xmm0\n");
+    fprintf(asm_out, ".L_return%d:\n", current_function);
+    if (saved_registers) {
+        fprintf(asm_out, "\tleaq -%d(%%rbp), %%rsp\n", 8 * saved_registers);
+        for (int r = REG_CALLEE_SAVED - 1; r >= 0; r--) {
+            if (calleeSaved[r]) fprintf(asm_out, "\tpopq %s\n", allocReg[r]);
+        }
+        fprintf(asm_out, "\tpopq %%rbp\n");
+    } else {
+        fprintf(asm_out, "\tleave\n");
+    }
+    fprintf(asm_out, "\tret\n");
+}
+
+// Elementos da lista de inicialização do vetor, até 16 por linha
+static void asmInitializer(Symbol* vector) {
+    const std::vector<Symbol*>& values = vector->initializer;
+    int size = sizeOf(vector->dataType);
+    const char* directive = vector->dataType == DATATYPE_STRING ? ".quad" :
+                            vector->dataType == DATATYPE_REAL ? ".double" : size == 1 ? ".byte" : ".long";
+    for (size_t i = 0; i < values.size(); i++) {
+        Symbol* value = values[i];
+        fprintf(asm_out, i % 16 == 0 ? "\t%s " : ", ", directive);
+        if (vector->dataType == DATATYPE_STRING && value->type == LIT_STRING)
+            fprintf(asm_out, ".L_str%d", value->id);
+        else if (vector->dataType == DATATYPE_REAL && value->type == LIT_REAL)
+            fprintf(asm_out, "%s", value->text.c_str());
+        else if (vector->dataType == DATATYPE_REAL)
+            fprintf(asm_out, "%ld.0", literalInt(value));
+        else if (size == 1)
+            fprintf(asm_out, "%d", (unsigned char)literalInt(value));
+        else
+            fprintf(asm_out, "%d", (int)literalInt(value));
+        if (i % 16 == 15 || i + 1 == values.size()) fprintf(asm_out, "\n");
+    }
+}
+
+// Declara as variáveis globais: escalares com inicializador literal e vetores
+// com lista de inicialização global em .data (o resto do vetor zerado), o
+// resto zerado em .bss. Vetores ocupam vector_length elementos
+static void asmGlobals(const std::vector<Symbol*>& staticValue, const std::vector<bool>& staticVector) {
+    fprintf(asm_out, "\n\t.data\n");
+    for (int id = 0; id < symbolCount(); id++) {
+        Symbol* s = symbolById(id);
+        if (!staticVector[id]) continue;
+
+        int size = sizeOf(s->dataType);
+        long tail = (long)size * (vector_length[id] - (long)s->initializer.size());
+        fprintf(asm_out, "\t.align %d\n", size);
+        fprintf(asm_out, "v_%s:\n", s->text.c_str());
+        asmInitializer(s);
+        if (tail > 0) fprintf(asm_out, "\t.zero %ld\n", tail);
+    }
+    for (int id = 0; id < symbolCount(); id++) {
+        Symbol* s = symbolById(id);
+        Symbol* value = staticValue[id];
+        if (!value) continue;
+
+        int size = sizeOf(s->dataType);
+        fprintf(asm_out, "\t.align %d\n", size);
+        fprintf(asm_out, "v_%s:\n", s->text.c_str());
+        if (s->dataType == DATATYPE_STRING)
+            fprintf(asm_out, "\t.quad .L_str%d\n", value->id);
+        else if (s->dataType == DATATYPE_REAL && value->type == LIT_REAL)
+            fprintf(asm_out, "\t.double %s\n", value->text.c_str());
+        else if (s->dataType == DATATYPE_REAL)
+            fprintf(asm_out, "\t.double %ld.0\n", literalInt(value));
+        else if (size == 1)
+            fprintf(asm_out, "\t.byte %ld\n", literalInt(value));
+        else
+            fprintf(asm_out, "\t.long %ld\n", literalInt(value));
+    }
+
+    fprintf(asm_out, "\n\t.bss\n");
+    if (simd_used) fprintf(asm_out, ".L_avx2:\n\t.zero 1\n");
+    for (int id = 0; id < symbolCount(); id++) {
+        Symbol* s = symbolById(id);
+        if (!isVariable(s) || staticValue[id] || staticVector[id]) continue;
+
+        int size = sizeOf(s->dataType);
+        int length = s->nature == SYMBOL_VECTOR ? vector_length[id] : 1;
+        if (length < 1) length = 1;
+        fprintf(asm_out, "\t.align %d\n", size);
+        fprintf(asm_out, "v_%s:\n", s->text.c_str());
+        fprintf(asm_out, "\t.zero %ld\n", (long)size * length);
+    }
+    fprintf(asm_out, "\t.align 8\n");
+    fprintf(asm_out, ".L_read_buffer:\n");
+    fprintf(asm_out, "\t.zero 8\n");
+}
+
+// Literais reais e strings, e os formatos de print/read
+static void asmLiterals(void) {
+    fprintf(asm_out, "\n\t.section .rodata\n");
+    for (int id = 0; id < symbolCount(); id++) {
+        Symbol* s = symbolById(id);
+        if (vector_blob[id]) {
+            fprintf(asm_out, "\t.align %d\n", sizeOf(s->dataType));
+            fprintf(asm_out, ".L_init%d:\n", id);
+            asmInitializer(s);
+        }
+        if (s->type == LIT_REAL) {
+            fprintf(asm_out, "\t.align 8\n");
+            fprintf(asm_out, ".L_real%d:\n", id);
+            fprintf(asm_out, "\t.double %s\n", s->text.c_str());
+        } else if (s->type == LIT_STRING) {
+            fprintf(asm_out, ".L_str%d:\n", id);
+            fprintf(asm_out, "\t.string %s\n", s->text.c_str());
+        }
+    }
+    fprintf(asm_out, ".L_fmt_int:\n\t.string \"%%ld\"\n");
+    fprintf(asm_out, ".L_fmt_real:\n\t.string \"%%f\"\n");
+    fprintf(asm_out, ".L_fmt_char:\n\t.string \"%%c\"\n");
+    fprintf(asm_out, ".L_fmt_string:\n\t.string \"%%s\"\n");
+    fprintf(asm_out, ".L_fmt_read_int:\n\t.string \"%%ld\"\n");
+    fprintf(asm_out, ".L_fmt_read_real:\n\t.string \"%%lf\"\n");
+    fprintf(asm_out, ".L_fmt_read_char:\n\t.string \" %%c\"\n");
+    fprintf(asm_out, ".L_fmt_bounds:\n\t.string \"index %%ld out of bounds\\n\"\n");
+}
+
+void asmGenerate(TAC* code, FILE* out, bool stats) {
+    asm_out = out;
+    asm_stats = stats;
+    temp_interval.assign(tacTempCount(), 0);
+    temp_owner.assign(tacTempCount(), 0);
+    current_function = 0;
+
+    // Separa o corpo de cada função (BEGINFUN..ENDFUN) do código de nível
+    // global, que é executado antes da função main
+    std::vector<Symbol*> functions;
+    std::vector<std::vector<TAC*> > bodies;
+    std::vector<TAC*> globalInit;
+
+    // Escalares globais com inicializador literal vão direto para .data
+    std::vector<Symbol*> staticValue(symbolCount(), (Symbol*)NULL);
+    // Vetores com lista de inicialização global vão direto para .data
+    std::vector<bool> staticVector(symbolCount(), false);
+
+    std::vector<TAC*>* body = NULL;
+    for (TAC* tac = code; tac; tac = tac->next) {
+        if (tac->type == TAC_BEGINFUN) {
+            functions.push_back((Symbol*)tac->res);
+            bodies.push_back(std::vector<TAC*>());
+            body = &bodies.back();
+        }
+        if (body) {
+            body->push_back(tac);
+            if (tac->type == TAC_ENDFUN) body = NULL;
+            continue;
+        }
+        if (tac->type == TAC_VECTOR_INIT) {
+            staticVector[((Symbol*)tac->res)->id] = true;
+            continue;
+        }
+
+        Symbol* res = (Symbol*)tac->res;
+        Symbol* op1 = (Symbol*)tac->op1;
+        if (tac->type == TAC_MOVE && isVariable(res) && isLiteral(op1) && !staticValue[res->id] &&
+            (kindOf(res->dataType) == KIND_STRING) == (op1->type == LIT_STRING)) {
+            staticValue[res->id] = op1;
+            continue;
+        }
+        globalInit.push_back(tac);
+    }
+
+    // Vetores comportam ao menos vectorSize elementos e toda a lista de inicialização
+    vector_length.assign(symbolCount(), 0);
+    for (int id = 0; id < symbolCount(); id++) {
+        Symbol* s = symbolById(id);
+        if (s->nature == SYMBOL_VECTOR) vector_length[id] = std::max(s->vectorSize, (int)s->initializer.size());
+    }
+    vector_blob.assign(symbolCount(), false);
+    bounds_checked = false;
+    simd_count = 0;
+    simd_used = false;
+
+    fprintf(asm_out, "\t.text\n");
+    for (size_t i = 0; i < functions.size(); i++) {
+        asmFunction(functions[i], bodies[i]);
+    }
+    asmFunction(NULL, globalInit);
+
+    // main em C: inicializa as globais e chama a função main do programa
+    Symbol* mainFunction = findFunction("main");
+    fprintf(asm_out, "\n\t.globl main\n");
+    fprintf(asm_out, "\t.type main, @function\n");
+    fprintf(asm_out, "main:\n");
+    fprintf(asm_out, "\tpushq %%rbp\n");
+    fprintf(asm_out, "\tmovq %%rsp, %%rbp\n");
+    if (simd_used) fprintf(asm_out, "\tcall .Lsimd_detect\n");
+    fprintf(asm_out, "\tcall .Lglobal_init\n");
+    if (mainFunction) {
+        fprintf(asm_out, "\tcall f_main\n");
+        if (kindOf(mainFunction->returnType) == KIND_REAL)
+            fprintf(asm_out, "\tcvttsd2si %%xmm0, %%rax\n");
+    } else {
+        fprintf(asm_out, "\txorl %%eax, %%eax\n");
+    }
+    fprintf(asm_out, "\tpopq %%rbp\n");
+    fprintf(asm_out, "\tret\n");
+
+    // AVX2 utilizável: a CPU tem a folha 7 do cpuid (folha máxima em 0.eax),
+    // AVX e AVX2 (cpuid 1.ecx bit 28 e 7.ebx bit 5) e o sistema salva os
+    // registradores ymm (OSXSAVE e bits 1-2 do XCR0); senão fica no SSE2
+    if (simd_used) {
+        fprintf(asm_out, "\n.Lsimd_detect:\n");
+        fprintf(asm_out, "\tpushq %%rbx\n");
+        fprintf(asm_out, "\txorl %%eax, %%eax\n");
+        fprintf(asm_out, "\tcpuid\n");
+        fprintf(asm_out, "\tcmpl $7, %%eax\n");
+        fprintf(asm_out, "\tjb .Lsimd_detect_end\n");
+        fprintf(asm_out, "\tmovl $1, %%eax\n");
+        fprintf(asm_out, "\tcpuid\n");
+        fprintf(asm_out, "\tbtl $27, %%ecx\n");
+        fprintf(asm_out, "\tjnc .Lsimd_detect_end\n");
+        fprintf(asm_out, "\tbtl $28, %%ecx\n");
+        fprintf(asm_out, "\tjnc .Lsimd_detect_end\n");
+        fprintf(asm_out, "\txorl %%ecx, %%ecx\n");
+        fprintf(asm_out, "\txgetbv\n");
+        fprintf(asm_out, "\tandl $6, %%eax\n");
+        fprintf(asm_out, "\tcmpl $6, %%eax\n");
+        fprintf(asm_out, "\tjne .Lsimd_detect_end\n");
+        fprintf(asm_out, "\tmovl $7, %%eax\n");
+        fprintf(asm_out, "\txorl %%ecx, %%ecx\n");
+        fprintf(asm_out, "\tcpuid\n");
+        fprintf(asm_out, "\tbtl $5, %%ebx\n");
+        fprintf(asm_out, "\tjnc .Lsimd_detect_end\n");
+        fprintf(asm_out, "\tmovb $1, .L_avx2(%%rip)\n");
+        fprintf(asm_out, ".Lsimd_detect_end:\n");
+        fprintf(asm_out, "\tpopq %%rbx\n");
+        fprintf(asm_out, "\tret\n");
+    }
+
+    // Índice de vetor fora dos limites (em rcx): mensagem e término com 1
+    if (bounds_checked) {
+        fprintf(asm_out, "\n.L_bounds_error:\n");
+        fprintf(asm_out, "\tandq $-16, %%rsp\n");
+        fprintf(asm_out, "\tmovq %%rcx, %%rsi\n");
+        fprintf(asm_out, "\tleaq .L_fmt_bounds(%%rip), %%rdi\n");
+        fprintf(asm_out, "\txorl %%eax, %%eax\n");
+        fprintf(asm_out, "\tcall printf@PLT\n");
+        fprintf(asm_out, "\tmovl $1, %%edi\n");
+        fprintf(asm_out, "\tcall exit@PLT\n");
+    }
+
+    asmGlobals(staticValue, staticVector);
+    asmLiterals();
+    fprintf(asm_out, "\n\t.section .note.GNU-stack,\"\",@progbits\n");
+}
@@ -0,0 +1,20 @@
+//
+// asm.hpp - Geração de código assembly x86-64 (System V, GNU as) a partir das TACs
+//
+
+#ifndef ASM_HPP
+#define ASM_HPP
+
+#include <stdio.h>
+#include "tacs.hpp"
+
+// Gera o programa assembly completo para a lista de TACs: variáveis globais
+// em .data/.bss, literais em .rodata, uma função por BEGINFUN..ENDFUN e um
+// main em C que executa as inicializações globais e chama a função main.
+// Com stats, o resumo da alocação de registradores de cada função vai para stderr
+void asmGenerate(TAC* code, FILE* out, bool stats);
+
+// Bytes de uma variável (ou de um elemento de vetor) do tipo em memória
+int asmElementSize(DataType type);
+
+#endif // ASM_HPP
@@ -6,28 +6,146 @@
 #include <cstring>
 #include <set>
 
-AST* astCreate(AstNodeType type, const void* symbol, AST* son0, AST* son1, AST* son2, AST* son3) {
-    AST* node = (AST*)malloc(sizeof(AST));
-    if (!node) {
+// Arena de nós da AST: blocos contíguos com alocação por incremento de ponteiro.
+// Nós criados em sequência (filhos antes do pai, irmãos em ordem) ficam
+// vizinhos na memória, e a liberação descarta blocos inteiros.
+#define AST_ARENA_FIRST_CHUNK 1024    // nós no primeiro bloco
+#define AST_ARENA_MAX_CHUNK   65536   // limite do crescimento geométrico
+
+typedef struct ast_chunk {
+    struct ast_chunk* prev;  // bloco anterior (lista para liberação)
+    int capacity;            // nós que cabem neste bloco
+    int used;                // nós já entregues
+    AST nodes[1];            // área dos nós (alocada com o tamanho real)
+} AstChunk;
+
+static AstChunk* arena_top = NULL;
+static AstArenaStats arena_stats = {0, 0, 0};
+
+static AstChunk* astArenaGrow(void) {
+    int capacity = arena_top ? arena_top->capacity * 2 : AST_ARENA_FIRST_CHUNK;
+    if (capacity > AST_ARENA_MAX_CHUNK) capacity = AST_ARENA_MAX_CHUNK;
+    
+    AstChunk* chunk = (AstChunk*)malloc(sizeof(AstChunk) + (capacity - 1) * sizeof(AST));
+    if (!chunk) {
         fprintf(stderr, "Erro de memória ao criar nó da AST\n");
         exit(1);
     }
+    chunk->prev = arena_top;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    arena_top = chunk;
+    arena_stats.chunks++;
+    return chunk;
+}
+
+AST* astCreate(AstNodeType type, const void* symbol, AST* son0, AST* son1, AST* son2, AST* son3) {
+    AstChunk* chunk = arena_top;
+    if (!chunk || chunk->used == chunk->capacity) {
+        chunk = astArenaGrow();
+    }
+    AST* node = &chunk->nodes[chunk->used++];
+    arena_stats.nodes++;
+    arena_stats.bytes += sizeof(AST);
+    
     node->type = type;
     node->symbol = (void*)symbol;
+    node->type_symbol = NULL;
     node->son[0] = son0;
     node->son[1] = son1;
     node->son[2] = son2;
     node->son[3] = son3;
     node->next = NULL;
     node->line_number = -1;
+    node->op = OP_NONE;
+    node->data_type = -1;
     return node;
 }
 
+// Libera todos os nós da compilação de uma vez (sem percorrer a árvore)
+void astArenaRelease(void) {
+    while (arena_top) {
+        AstChunk* prev = arena_top->prev;
+        free(arena_top);
+        arena_top = prev;
+    }
+    arena_stats.nodes = 0;
+    arena_stats.bytes = 0;
+    arena_stats.chunks = 0;
+}
+
+AstArenaStats astArenaGetStats(void) {
+    return arena_stats;
+}
+
+// Inicia a travessia a partir de root (e de seus irmãos)
+void astWalkBegin(AstWalker* walker, AST* root) {
+    walker->stack.clear();
+    walker->pushedSons = 0;
+    if (root) {
+        AstStep step = {root, 0, false};
+        walker->stack.push_back(step);
+    }
+}
+
+// Obtém o próximo passo da travessia; retorna false ao terminar
+bool astWalkNext(AstWalker* walker, AstStep* step) {
+    walker->pushedSons = 0;
+    if (walker->stack.empty()) return false;
+    
+    *step = walker->stack.back();
+    walker->stack.pop_back();
+    
+    if (!step->post) {
+        AST* node = step->node;
+        
+        // Ordem de saída da pilha: filhos, saída do nó, irmão seguinte
+        if (node->next) {
+            AstStep sibling = {node->next, step->level, false};
+            walker->stack.push_back(sibling);
+        }
+        AstStep leave = {node, step->level, true};
+        walker->stack.push_back(leave);
+        for (int i = 3; i >= 0; i--) {
+            if (node->son[i]) {
+                AstStep son = {node->son[i], step->level + 1, false};
+                walker->stack.push_back(son);
+                walker->pushedSons++;
+            }
+        }
+    }
+    return true;
+}
+
+// Chamado logo após a entrada em um nó: não visita seus filhos
+void astWalkSkipSons(AstWalker* walker) {
+    walker->stack.resize(walker->stack.size() - walker->pushedSons);
+    walker->pushedSons = 0;
+}
+
+// Lista com um único nó (ou vazia, se node for NULL)
+AstList astListOf(AST* node) {
+    AstList list;
+    list.head = node;
+    list.tail = node;
+    return list;
+}
+
+// Anexa um nó ao fim da lista sem percorrê-la
+AstList astListAppend(AstList list, AST* node) {
+    if (!node) return list;
+    if (!list.head) return astListOf(node);
+    list.tail->next = node;
+    list.tail = node;
+    return list;
+}
+
 const char* astTypeName(AstNodeType type) {
     switch(type) {
         case AST_PROGRAMA: return "PROGRAMA";
         case AST_DECL_LIST: return "DECL_LIST";
         case AST_VAR_DECL: return "VAR_DECL";
+        case AST_VEC_DECL: return "VEC_DECL";
         case AST_FUNC_DECL: return "FUNC_DECL";
         case AST_PARAM_LIST: return "PARAM_LIST";
         case AST_CMD_LIST: return "CMD_LIST";
@@ -49,34 +167,44 @@ const char* astTypeName(AstNodeType type) {
     }
 }
 
+// Nome de cada operador, indexado por AstOperator
+static const char* const astOperatorNames[OP_COUNT] = {
+    "?", "+", "-", "*", "/", "<", ">", "<=", ">=", "==", "!=", "INDEX"
+};
+
+const char* astOperatorName(AstOperator op) {
+    if (op < 0 || op >= OP_COUNT) return "?";
+    return astOperatorNames[op];
+}
+
 // Função auxiliar para imprimir símbolo (identificador/literal)
 void astPrintSymbol(void* symbol, AstNodeType type) {
     if (!symbol) return;
     if (type == AST_SYMBOL) {
         printf("%s", ((Symbol*)symbol)->text.c_str());
-    } else if (type == AST_OP) {
-        printf("%s", (const char*)symbol);
     } else {
         printf("?");
     }
 }
 
 void astPrint(AST* node, int level) {
-    if (!node) return;
-    for (int i = 0; i < level; ++i) printf("  ");
-    printf("[%s", astTypeName(node->type));
-    if (node->symbol) {
-        printf(", symbol=");
-        astPrintSymbol(node->symbol, node->type);
-    }
-    printf("]\n");
-    for (int i = 0; i < 4; ++i) {
-        if (node->son[i]) {
-            astPrint(node->son[i], level + 1);
+    AstWalker walker;
+    AstStep step;
+    
+    astWalkBegin(&walker, node);
+    while (astWalkNext(&walker, &step)) {
+        if (step.post) continue;
+        
+        node = step.node;
+        for (int i = 0; i < level + step.level; ++i) printf("  ");
+        printf("[%s", astTypeName(node->type));
+        if (node->type == AST_OP) {
+            printf(", symbol=%s", astOperatorName(node->op));
+        } else if (node->symbol) {
+            printf(", symbol=");
+            astPrintSymbol(node->symbol, node->type);
         }
-    }
-    if (node->next) {
-        astPrint(node->next, level);
+        printf("]\n");
     }
 }
 
@@ -104,7 +232,7 @@ void astDecompileExpr(AST* node, FILE* out) {
         case AST_OP:
         {
             // Acesso a vetor: v[i]
-            if (node->symbol && strcmp((const char*)node->symbol, "INDEX") == 0) {
+            if (node->op == OP_INDEX) {
                 if (node->son[0]) astDecompileExpr(node->son[0], out);
                 fprintf(out, "[");
                 if (node->son[1]) astDecompileExpr(node->son[1], out);
@@ -113,7 +241,7 @@ void astDecompileExpr(AST* node, FILE* out) {
                 // Operação binária normal
                 fprintf(out, "(");
                 if (node->son[0]) astDecompileExpr(node->son[0], out);
-                if (node->symbol) fprintf(out, " %s ", (const char*)node->symbol);
+                fprintf(out, " %s ", astOperatorName(node->op));
                 if (node->son[1]) astDecompileExpr(node->son[1], out);
                 fprintf(out, ")");
             }
@@ -155,6 +283,7 @@ void astDecompile(AST* node, FILE* out) {
     // Imprimir indentação para comandos (exceto blocos)
     if (node->type != AST_BLOCK && node->type != AST_PROGRAMA && 
         node->type != AST_DECL_LIST && node->type != AST_VAR_DECL && 
+        node->type != AST_VEC_DECL && 
         node->type != AST_FUNC_DECL && node->type != AST_PARAM_LIST) {
         printIndent(out, indent_level);
     }
@@ -197,6 +326,7 @@ void astDecompile(AST* node, FILE* out) {
             }
             break;
         case AST_VAR_DECL:
+        case AST_VEC_DECL:
         {
             // Indentação só para variáveis locais
             bool is_local = (indent_level > 0);
@@ -222,25 +352,21 @@ void astDecompile(AST* node, FILE* out) {
                 fprintf(out, "%s", ((Symbol*)node->symbol)->text.c_str());
             }
             
-            // Determinar o tipo de declaração baseado na estrutura da AST
-            if (node->son[0]) {
-                // Verificar se é um vetor ou uma variável simples com inicialização
+            if (node->type == AST_VEC_DECL) {
+                // Vetor: int v[10]; ou int v[10] = 0, 1, 2, ...
+                fprintf(out, "[");
+                astDecompileExpr(node->son[0], out);
+                fprintf(out, "]");
+                
                 if (node->son[1]) {
-                    // Vetor com inicialização: int v[10] = 0, 1, 2, ...
-                    fprintf(out, "[");
-                    astDecompileExpr(node->son[0], out);
-                    fprintf(out, "] = ");
-                    
                     // Imprimir lista de valores iniciais
-                    astDecompileExpr(node->son[1], out);
-                    
-                    // Os demais literais serão processados pela chamada recursiva
-                    // que trata os irmãos (next) em AST_EXPR_LIST
-                } else {
-                    // Variável simples com inicialização: int a = 0;
                     fprintf(out, " = ");
-                    astDecompileExpr(node->son[0], out);
+                    astDecompileExpr(node->son[1], out);
                 }
+            } else if (node->son[0]) {
+                // Variável simples com inicialização: int a = 0;
+                fprintf(out, " = ");
+                astDecompileExpr(node->son[0], out);
             }
             
             fprintf(out, ";\n");
@@ -470,7 +596,7 @@ void astDecompile(AST* node, FILE* out) {
         }
 
         case AST_OP:
-            if (node->symbol && strcmp((const char*)node->symbol, "INDEX") == 0) {
+            if (node->op == OP_INDEX) {
                 // Acesso a vetor: v[i]
                 if (node->son[0]) astDecompileExpr(node->son[0], out);
                 fprintf(out, "[");
@@ -480,7 +606,7 @@ void astDecompile(AST* node, FILE* out) {
                 // Operação binária normal
                 fprintf(out, "(");
                 if (node->son[0]) astDecompileExpr(node->son[0], out);
-                if (node->symbol) fprintf(out, " %s ", (const char*)node->symbol);
+                fprintf(out, " %s ", astOperatorName(node->op));
                 if (node->son[1]) astDecompileExpr(node->son[1], out);
                 fprintf(out, ")");
             }
@@ -510,7 +636,7 @@ void astDecompileSimple(AST* node, FILE* out) {
     // Percorrer todas as declarações globais
     for (AST* decl = node; decl != NULL; decl = decl->next) {
         // Processar declaração de variável global
-        if (decl->type == AST_VAR_DECL) {
+        if (decl->type == AST_VAR_DECL || decl->type == AST_VEC_DECL) {
             // Tipo da variável
             if (decl->type_symbol) {
                 Symbol* sym = (Symbol*)decl->type_symbol;
@@ -529,14 +655,14 @@ void astDecompileSimple(AST* node, FILE* out) {
                 fprintf(out, "%s", ((Symbol*)decl->symbol)->text.c_str());
             }
             
-            // Determinar o tipo de declaração baseado na estrutura da AST
-            if (decl->son[0]) {
-                // Verificar se é um vetor ou uma variável simples com inicialização
+            if (decl->type == AST_VEC_DECL) {
+                // Vetor: int v[10]; ou int v[10] = 0, 1, 2, ...
+                fprintf(out, "[");
+                astDecompileExpr(decl->son[0], out);
+                fprintf(out, "]");
+                
                 if (decl->son[1]) {
-                    // Vetor com inicialização: int v[10] = 0, 1, 2, ...
-                    fprintf(out, "[");
-                    astDecompileExpr(decl->son[0], out);
-                    fprintf(out, "] = ");
+                    fprintf(out, " = ");
                     
                     // Imprimir lista de valores iniciais
                     AST* lit = decl->son[1];
@@ -547,19 +673,11 @@ void astDecompileSimple(AST* node, FILE* out) {
                         first = false;
                         lit = lit->next;
                     }
-                } else {
-                    // Verificar se é um vetor sem inicialização
-                    Symbol* sym = (Symbol*)decl->symbol;
-                    if (sym && sym->nature == SYMBOL_VECTOR) {
-                        fprintf(out, "[");
-                        astDecompileExpr(decl->son[0], out);
-                        fprintf(out, "]");
-                    } else {
-                        // Variável simples com inicialização: int a = 0;
-                        fprintf(out, " = ");
-                        astDecompileExpr(decl->son[0], out);
-                    }
                 }
+            } else if (decl->son[0]) {
+                // Variável simples com inicialização: int a = 0;
+                fprintf(out, " = ");
+                astDecompileExpr(decl->son[0], out);
             }
             
             fprintf(out, ";\n");
@@ -636,269 +754,267 @@ void astDecompileSimple(AST* node, FILE* out) {
 
 // Função auxiliar para descompilação de comandos com indentação
 void decompileCommands(AST* cmd, FILE* out, int indent) {
-    if (!cmd) return;
-    
-    // Imprimir indentação
-    for (int i = 0; i < indent; i++) {
-        fprintf(out, "  "); // 2 espaços por nível de indentação
-    }
+    // Percorre a lista de comandos iterativamente (sem recursão em next)
+    for (; cmd; cmd = cmd->next) {
+        // Imprimir indentação
+        for (int i = 0; i < indent; i++) {
+            fprintf(out, "  "); // 2 espaços por nível de indentação
+        }
     
-    // Processar comando
-    switch (cmd->type) {
-        case AST_RETURN:
-            fprintf(out, "return ");
-            if (cmd->son[0]) {
-                astDecompileExpr(cmd->son[0], out);
-            }
-            fprintf(out, ";\n");
-            break;
-            
-        case AST_ASSIGN:
-            if (cmd->symbol) {
-                fprintf(out, "%s", ((Symbol*)cmd->symbol)->text.c_str());
-                
-                // Verificar se é atribuição a vetor
-                if (cmd->son[0] && cmd->son[1]) {
-                    fprintf(out, "[");
-                    astDecompileExpr(cmd->son[0], out);
-                    fprintf(out, "] = ");
-                    astDecompileExpr(cmd->son[1], out);
-                } else {
-                    fprintf(out, " = ");
+        // Processar comando
+        switch (cmd->type) {
+            case AST_RETURN:
+                fprintf(out, "return ");
+                if (cmd->son[0]) {
                     astDecompileExpr(cmd->son[0], out);
                 }
                 fprintf(out, ";\n");
-            }
-            break;
+                break;
             
-        case AST_PRINT:
-            fprintf(out, "print ");
-            if (cmd->son[0]) {
-                // Processar lista de expressões
-                AST* expr = cmd->son[0];
-                bool first = true;
-                while (expr) {
-                    if (!first) fprintf(out, " ");
-                    astDecompileExpr(expr, out);
-                    first = false;
-                    expr = expr->next;
+            case AST_ASSIGN:
+                if (cmd->symbol) {
+                    fprintf(out, "%s", ((Symbol*)cmd->symbol)->text.c_str());
+                
+                    // Verificar se é atribuição a vetor
+                    if (cmd->son[0] && cmd->son[1]) {
+                        fprintf(out, "[");
+                        astDecompileExpr(cmd->son[0], out);
+                        fprintf(out, "] = ");
+                        astDecompileExpr(cmd->son[1], out);
+                    } else {
+                        fprintf(out, " = ");
+                        astDecompileExpr(cmd->son[0], out);
+                    }
+                    fprintf(out, ";\n");
                 }
-            }
-            fprintf(out, ";\n");
-            break;
-            
-        case AST_READ:
-            fprintf(out, "read ");
-            if (cmd->symbol) {
-                fprintf(out, "%s", ((Symbol*)cmd->symbol)->text.c_str());
-            }
-            fprintf(out, ";\n");
-            break;
+                break;
             
-        case AST_IF:
-            fprintf(out, "if (");
-            if (cmd->son[0]) astDecompileExpr(cmd->son[0], out);
-            fprintf(out, ") \n");
-            
-            // Processar bloco do if
-            if (cmd->son[1]) {
-                if (cmd->son[1]->type == AST_BLOCK) {
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
+            case AST_PRINT:
+                fprintf(out, "print ");
+                if (cmd->son[0]) {
+                    // Processar lista de expressões
+                    AST* expr = cmd->son[0];
+                    bool first = true;
+                    while (expr) {
+                        if (!first) fprintf(out, " ");
+                        astDecompileExpr(expr, out);
+                        first = false;
+                        expr = expr->next;
                     }
-                    fprintf(out, "{\n");
+                }
+                fprintf(out, ";\n");
+                break;
+            
+            case AST_READ:
+                fprintf(out, "read ");
+                if (cmd->symbol) {
+                    fprintf(out, "%s", ((Symbol*)cmd->symbol)->text.c_str());
+                }
+                fprintf(out, ";\n");
+                break;
+            
+            case AST_IF:
+                fprintf(out, "if (");
+                if (cmd->son[0]) astDecompileExpr(cmd->son[0], out);
+                fprintf(out, ") \n");
+            
+                // Processar bloco do if
+                if (cmd->son[1]) {
+                    if (cmd->son[1]->type == AST_BLOCK) {
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "{\n");
                     
-                    // Processar comandos dentro do bloco
-                    if (cmd->son[1]->son[0]) {
-                        decompileCommands(cmd->son[1]->son[0], out, indent + 1);
-                    }
+                        // Processar comandos dentro do bloco
+                        if (cmd->son[1]->son[0]) {
+                            decompileCommands(cmd->son[1]->son[0], out, indent + 1);
+                        }
                     
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "}\n");
+                    } else {
+                        decompileCommands(cmd->son[1], out, indent + 1);
                     }
-                    fprintf(out, "}\n");
-                } else {
-                    decompileCommands(cmd->son[1], out, indent + 1);
                 }
-            }
-            break;
-            
-        case AST_IF_ELSE:
-            fprintf(out, "if (");
-            if (cmd->son[0]) astDecompileExpr(cmd->son[0], out);
-            fprintf(out, ") \n");
-            
-            // Processar bloco do if
-            if (cmd->son[1]) {
-                if (cmd->son[1]->type == AST_BLOCK) {
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
-                    }
-                    fprintf(out, "{\n");
+                break;
+            
+            case AST_IF_ELSE:
+                fprintf(out, "if (");
+                if (cmd->son[0]) astDecompileExpr(cmd->son[0], out);
+                fprintf(out, ") \n");
+            
+                // Processar bloco do if
+                if (cmd->son[1]) {
+                    if (cmd->son[1]->type == AST_BLOCK) {
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "{\n");
                     
-                    // Processar comandos dentro do bloco
-                    if (cmd->son[1]->son[0]) {
-                        decompileCommands(cmd->son[1]->son[0], out, indent + 1);
-                    }
+                        // Processar comandos dentro do bloco
+                        if (cmd->son[1]->son[0]) {
+                            decompileCommands(cmd->son[1]->son[0], out, indent + 1);
+                        }
                     
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "}\n");
+                    } else {
+                        decompileCommands(cmd->son[1], out, indent + 1);
                     }
-                    fprintf(out, "}\n");
-                } else {
-                    decompileCommands(cmd->son[1], out, indent + 1);
                 }
-            }
             
-            // Imprimir indentação
-            for (int i = 0; i < indent; i++) {
-                fprintf(out, "  ");
-            }
-            fprintf(out, "else \n");
-            
-            // Processar bloco do else
-            if (cmd->son[2]) {
-                if (cmd->son[2]->type == AST_BLOCK) {
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
-                    }
-                    fprintf(out, "{\n");
+                // Imprimir indentação
+                for (int i = 0; i < indent; i++) {
+                    fprintf(out, "  ");
+                }
+                fprintf(out, "else \n");
+            
+                // Processar bloco do else
+                if (cmd->son[2]) {
+                    if (cmd->son[2]->type == AST_BLOCK) {
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "{\n");
                     
-                    // Processar comandos dentro do bloco
-                    if (cmd->son[2]->son[0]) {
-                        decompileCommands(cmd->son[2]->son[0], out, indent + 1);
-                    }
+                        // Processar comandos dentro do bloco
+                        if (cmd->son[2]->son[0]) {
+                            decompileCommands(cmd->son[2]->son[0], out, indent + 1);
+                        }
                     
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "}\n");
+                    } else {
+                        decompileCommands(cmd->son[2], out, indent + 1);
                     }
-                    fprintf(out, "}\n");
-                } else {
-                    decompileCommands(cmd->son[2], out, indent + 1);
                 }
-            }
-            break;
-            
-        case AST_WHILE:
-            fprintf(out, "while (");
-            if (cmd->son[0]) astDecompileExpr(cmd->son[0], out);
-            fprintf(out, ") do\n");
-            
-            // Processar bloco do while
-            if (cmd->son[1]) {
-                if (cmd->son[1]->type == AST_BLOCK) {
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
-                    }
-                    fprintf(out, "{\n");
+                break;
+            
+            case AST_WHILE:
+                fprintf(out, "while (");
+                if (cmd->son[0]) astDecompileExpr(cmd->son[0], out);
+                fprintf(out, ") do\n");
+            
+                // Processar bloco do while
+                if (cmd->son[1]) {
+                    if (cmd->son[1]->type == AST_BLOCK) {
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "{\n");
                     
-                    // Processar comandos dentro do bloco
-                    if (cmd->son[1]->son[0]) {
-                        decompileCommands(cmd->son[1]->son[0], out, indent + 1);
-                    }
+                        // Processar comandos dentro do bloco
+                        if (cmd->son[1]->son[0]) {
+                            decompileCommands(cmd->son[1]->son[0], out, indent + 1);
+                        }
                     
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "}\n");
+                    } else {
+                        decompileCommands(cmd->son[1], out, indent + 1);
                     }
-                    fprintf(out, "}\n");
-                } else {
-                    decompileCommands(cmd->son[1], out, indent + 1);
                 }
-            }
-            break;
+                break;
             
-        case AST_DO_WHILE:
-            fprintf(out, "do\n");
-            
-            // Processar bloco do do-while
-            if (cmd->son[0]) {
-                if (cmd->son[0]->type == AST_BLOCK) {
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
-                    }
-                    fprintf(out, "{\n");
+            case AST_DO_WHILE:
+                fprintf(out, "do\n");
+            
+                // Processar bloco do do-while
+                if (cmd->son[0]) {
+                    if (cmd->son[0]->type == AST_BLOCK) {
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "{\n");
                     
-                    // Processar comandos dentro do bloco
-                    if (cmd->son[0]->son[0]) {
-                        decompileCommands(cmd->son[0]->son[0], out, indent + 1);
-                    }
+                        // Processar comandos dentro do bloco
+                        if (cmd->son[0]->son[0]) {
+                            decompileCommands(cmd->son[0]->son[0], out, indent + 1);
+                        }
                     
-                    // Imprimir indentação
-                    for (int i = 0; i < indent; i++) {
-                        fprintf(out, "  ");
+                        // Imprimir indentação
+                        for (int i = 0; i < indent; i++) {
+                            fprintf(out, "  ");
+                        }
+                        fprintf(out, "}\n");
+                    } else {
+                        decompileCommands(cmd->son[0], out, indent + 1);
                     }
-                    fprintf(out, "}\n");
-                } else {
-                    decompileCommands(cmd->son[0], out, indent + 1);
                 }
-            }
             
-            // Imprimir indentação
-            for (int i = 0; i < indent; i++) {
-                fprintf(out, "  ");
-            }
-            fprintf(out, "while (");
-            if (cmd->son[1]) astDecompileExpr(cmd->son[1], out);
-            fprintf(out, ");\n");
-            break;
+                // Imprimir indentação
+                for (int i = 0; i < indent; i++) {
+                    fprintf(out, "  ");
+                }
+                fprintf(out, "while (");
+                if (cmd->son[1]) astDecompileExpr(cmd->son[1], out);
+                fprintf(out, ");\n");
+                break;
             
-        case AST_BLOCK:
-            fprintf(out, "{\n");
+            case AST_BLOCK:
+                fprintf(out, "{\n");
             
-            // Processar comandos dentro do bloco
-            if (cmd->son[0]) {
-                decompileCommands(cmd->son[0], out, indent + 1);
-            }
+                // Processar comandos dentro do bloco
+                if (cmd->son[0]) {
+                    decompileCommands(cmd->son[0], out, indent + 1);
+                }
             
-            // Imprimir indentação
-            for (int i = 0; i < indent; i++) {
-                fprintf(out, "  ");
-            }
-            fprintf(out, "}\n");
-            break;
+                // Imprimir indentação
+                for (int i = 0; i < indent; i++) {
+                    fprintf(out, "  ");
+                }
+                fprintf(out, "}\n");
+                break;
             
-        case AST_FUNC_CALL:
-            if (cmd->symbol) {
-                fprintf(out, "%s", ((Symbol*)cmd->symbol)->text.c_str());
-            }
-            fprintf(out, "(");
+            case AST_FUNC_CALL:
+                if (cmd->symbol) {
+                    fprintf(out, "%s", ((Symbol*)cmd->symbol)->text.c_str());
+                }
+                fprintf(out, "(");
             
-            // Processar argumentos
-            if (cmd->son[0]) {
-                AST* arg = cmd->son[0];
-                bool first = true;
-                while (arg) {
-                    if (!first) fprintf(out, ", ");
-                    astDecompileExpr(arg, out);
-                    first = false;
-                    arg = arg->next;
+                // Processar argumentos
+                if (cmd->son[0]) {
+                    AST* arg = cmd->son[0];
+                    bool first = true;
+                    while (arg) {
+                        if (!first) fprintf(out, ", ");
+                        astDecompileExpr(arg, out);
+                        first = false;
+                        arg = arg->next;
+                    }
                 }
-            }
-            fprintf(out, ");\n");
-            break;
-    }
-    
-    // Processar próximo comando
-    if (cmd->next) {
-        decompileCommands(cmd->next, out, indent);
+                fprintf(out, ");\n");
+                break;
+            
+            default:
+                // Declarações (AST_VAR_DECL, AST_VEC_DECL) e nós de expressão
+                // não aparecem como comandos
+                break;
+        }
     }
 }
 
 
+// Os nós pertencem à arena: liberar a árvore libera a arena inteira
 void astFree(AST* node) {
     if (!node) return;
-    for (int i = 0; i < 4; ++i) {
-        astFree(node->son[i]);
-    }
-    astFree(node->next);
-    free(node);
+    astArenaRelease();
 }
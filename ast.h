@@ -2,12 +2,14 @@
 #define AST_H
 
 #include <stdio.h>
+#include <vector>
 
 // Enum para tipos de nó da AST
 typedef enum {
     AST_PROGRAMA,
     AST_DECL_LIST,
     AST_VAR_DECL,
+    AST_VEC_DECL,  // Vetor: son[0] = tamanho, son[1] = literais iniciais (opcional)
     AST_FUNC_DECL,
     AST_PARAM_LIST,
     AST_CMD_LIST,
@@ -28,6 +30,23 @@ typedef enum {
     // ... adicione outros tipos conforme necessário
 } AstNodeType;
 
+// Operadores dos nós AST_OP (definidos pelo parser)
+typedef enum {
+    OP_NONE,
+    OP_ADD,     // +
+    OP_SUB,     // -
+    OP_MUL,     // *
+    OP_DIV,     // /
+    OP_LT,      // <
+    OP_GT,      // >
+    OP_LE,      // <=
+    OP_GE,      // >=
+    OP_EQ,      // == (ou = em expressões)
+    OP_NE,      // !=
+    OP_INDEX,   // acesso a vetor: v[i]
+    OP_COUNT
+} AstOperator;
+
 // Estrutura do nó da AST
 typedef struct ast_node {
     AstNodeType type;
@@ -36,14 +55,55 @@ typedef struct ast_node {
     struct ast_node* son[4]; // até 4 filhos
     struct ast_node* next;   // para listas encadeadas à direita
     int line_number;         // linha do código fonte
+    AstOperator op;          // operador (apenas em nós AST_OP)
+    int data_type;           // DataType da expressão, calculado uma vez (-1 = ainda não)
 } AST;
 
+// Lista de nós em construção (usada pelo parser): guarda o último elemento
+// para anexar em O(1); os nós continuam encadeados por next
+typedef struct ast_list {
+    AST* head;
+    AST* tail;
+} AstList;
+
+// Passo de uma travessia da AST: cada nó aparece duas vezes, na entrada
+// (pré-ordem) e na saída (pós-ordem, depois dos filhos e antes dos irmãos)
+typedef struct {
+    AST* node;
+    int level;   // profundidade: filhos em level + 1, irmãos (next) no mesmo nível
+    bool post;   // false = entrada, true = saída
+} AstStep;
+
+// Travessia em profundidade sem recursão: a pilha de trabalho fica no heap,
+// então a pilha nativa não cresce com o tamanho das listas nem da árvore
+typedef struct {
+    std::vector<AstStep> stack;
+    int pushedSons;  // filhos empilhados na última entrada (para astWalkSkipSons)
+} AstWalker;
+
+// Estatísticas da arena que aloca os nós da AST
+typedef struct {
+    long nodes;   // nós alocados desde a última liberação
+    long bytes;   // bytes ocupados pelos nós
+    long chunks;  // blocos obtidos com malloc
+} AstArenaStats;
+
 // Funções utilitárias
 AST* astCreate(AstNodeType type, const void* symbol, AST* son0, AST* son1, AST* son2, AST* son3);
+const char* astOperatorName(AstOperator op);
 void astPrint(AST* node, int level);
 void astDecompile(AST* node, FILE* out);
 void astDecompileSimple(AST* node, FILE* out);
 void decompileCommands(AST* cmd, FILE* out, int indent);
 void astFree(AST* node);
+void astWalkBegin(AstWalker* walker, AST* root);
+bool astWalkNext(AstWalker* walker, AstStep* step);
+void astWalkSkipSons(AstWalker* walker);
+AstList astListOf(AST* node);
+AstList astListAppend(AstList list, AST* node);
+
+// Arena da compilação: todos os nós vêm dela e são liberados de uma vez
+void astArenaRelease(void);
+AstArenaStats astArenaGetStats(void);
 
 #endif // AST_H
@@ -0,0 +1,290 @@
+//
+// cfg.cpp - Grafo de fluxo de controle, dominadores e laços sobre as TACs
+//
+// Os blocos são numerados na ordem das TACs. Os dominadores usam o algoritmo
+// iterativo de Cooper, Harvey e Kennedy sobre a pós-ordem reversa, e os laços
+// são encontrados percorrendo a árvore de dominadores em pós-ordem (laços
+// internos primeiro), colapsando os já encontrados no seu cabeçalho. Todas as
+// travessias são iterativas.
+//
+
+#include "cfg.hpp"
+#include <climits>
+
+// Cria um bloco começando na TAC first
+static int cfgNewBlock(CFG* cfg, TAC* first) {
+    BasicBlock block;
+    block.id = (int)cfg->blocks.size();
+    block.first = first;
+    block.last = first;
+    block.rpo = -1;
+    block.idom = -1;
+    block.domPre = -1;
+    block.domPost = -1;
+    block.loop = -1;
+    cfg->blocks.push_back(block);
+    return block.id;
+}
+
+static void cfgAddEdge(CFG* cfg, int from, int to) {
+    if (to < 0) return;
+    std::vector<int>& succ = cfg->blocks[from].succ;
+    for (int s : succ) {
+        if (s == to) return;
+    }
+    succ.push_back(to);
+    cfg->blocks[to].pred.push_back(from);
+}
+
+// Bloco que começa no label (-1 se o label não pertence à função)
+int cfgBlockOf(const CFG* cfg, Symbol* label) {
+    int index = label->number - cfg->labelBase;
+    if (index < 0 || index >= (int)cfg->labelBlock.size()) return -1;
+    return cfg->labelBlock[index];
+}
+
+CFG* cfgBuild(TAC* begin) {
+    CFG* cfg = new CFG();
+    cfg->function = (Symbol*)begin->res;
+    cfg->begin = begin;
+    cfg->end = begin;
+
+    // Fim da função e faixa de números dos labels
+    int minLabel = INT_MAX, maxLabel = -1;
+    for (TAC* tac = begin; tac; tac = tac->next) {
+        cfg->end = tac;
+        if (tac->type == TAC_LABEL) {
+            int number = ((Symbol*)tac->res)->number;
+            if (number < minLabel) minLabel = number;
+            if (number > maxLabel) maxLabel = number;
+        }
+        if (tac->type == TAC_ENDFUN) break;
+    }
+    cfg->labelBase = maxLabel < 0 ? 0 : minLabel;
+    cfg->labelBlock.assign(maxLabel < 0 ? 0 : maxLabel - minLabel + 1, -1);
+
+    // Blocos: começam em labels e depois de desvios
+    bool leader = true;
+    for (TAC* tac = begin; ; tac = tac->next) {
+        if (tac->type == TAC_LABEL) leader = true;
+        if (leader) {
+            cfgNewBlock(cfg, tac);
+            leader = false;
+        }
+        BasicBlock& block = cfg->blocks.back();
+        block.last = tac;
+        if (tac->type == TAC_LABEL) {
+            cfg->labelBlock[((Symbol*)tac->res)->number - cfg->labelBase] = block.id;
+        }
+        if (tac->type == TAC_JUMP || tacIsConditionalJump(tac) || tac->type == TAC_RET) leader = true;
+        if (tac == cfg->end) break;
+    }
+
+    // Arestas
+    int count = (int)cfg->blocks.size();
+    for (int b = 0; b < count; b++) {
+        TAC* last = cfg->blocks[b].last;
+        if (tacIsConditionalJump(last)) {
+            cfgAddEdge(cfg, b, cfgBlockOf(cfg, (Symbol*)last->res));
+            if (b + 1 < count) cfgAddEdge(cfg, b, b + 1);
+            continue;
+        }
+        switch (last->type) {
+            case TAC_JUMP:
+                cfgAddEdge(cfg, b, cfgBlockOf(cfg, (Symbol*)last->res));
+                break;
+            case TAC_RET:
+            case TAC_ENDFUN:
+                break;
+            default:
+                if (b + 1 < count) cfgAddEdge(cfg, b, b + 1);
+                break;
+        }
+    }
+
+    cfgComputeDominators(cfg);
+    cfgFindLoops(cfg);
+    return cfg;
+}
+
+void cfgFree(CFG* cfg) {
+    delete cfg;
+}
+
+// Pós-ordem reversa dos blocos alcançáveis a partir da entrada (DFS iterativa)
+static void cfgComputeOrder(CFG* cfg) {
+    int count = (int)cfg->blocks.size();
+    std::vector<int> postorder;
+    std::vector<char> visited(count, 0);
+    std::vector<std::pair<int, int> > stack;   // (bloco, próximo sucessor)
+
+    postorder.reserve(count);
+    if (count > 0) {
+        stack.push_back(std::make_pair(0, 0));
+        visited[0] = 1;
+    }
+    while (!stack.empty()) {
+        std::pair<int, int>& top = stack.back();
+        const std::vector<int>& succ = cfg->blocks[top.first].succ;
+        if (top.second < (int)succ.size()) {
+            int next = succ[top.second++];
+            if (!visited[next]) {
+                visited[next] = 1;
+                stack.push_back(std::make_pair(next, 0));
+            }
+        } else {
+            postorder.push_back(top.first);
+            stack.pop_back();
+        }
+    }
+
+    cfg->order.assign(postorder.rbegin(), postorder.rend());
+    for (int b = 0; b < count; b++) {
+        cfg->blocks[b].rpo = -1;
+    }
+    for (int i = 0; i < (int)cfg->order.size(); i++) {
+        cfg->blocks[cfg->order[i]].rpo = i;
+    }
+}
+
+// Ancestral comum mais próximo na árvore de dominadores parcial
+static int cfgIntersect(const CFG* cfg, int a, int b) {
+    while (a != b) {
+        while (cfg->blocks[a].rpo > cfg->blocks[b].rpo) a = cfg->blocks[a].idom;
+        while (cfg->blocks[b].rpo > cfg->blocks[a].rpo) b = cfg->blocks[b].idom;
+    }
+    return a;
+}
+
+void cfgComputeDominators(CFG* cfg) {
+    cfgComputeOrder(cfg);
+
+    int count = (int)cfg->blocks.size();
+    for (int b = 0; b < count; b++) {
+        cfg->blocks[b].idom = -1;
+        cfg->blocks[b].domPre = -1;
+        cfg->blocks[b].domPost = -1;
+    }
+    if (cfg->order.empty()) return;
+
+    int entry = cfg->order[0];
+    cfg->blocks[entry].idom = entry;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < cfg->order.size(); i++) {
+            BasicBlock& block = cfg->blocks[cfg->order[i]];
+            int idom = -1;
+            for (int p : block.pred) {
+                if (cfg->blocks[p].idom < 0) continue;
+                idom = idom < 0 ? p : cfgIntersect(cfg, p, idom);
+            }
+            if (idom != block.idom) {
+                block.idom = idom;
+                changed = true;
+            }
+        }
+    }
+    cfg->blocks[entry].idom = -1;
+
+    // Numeração pré/pós-ordem da árvore de dominadores: a domina b se o
+    // intervalo de b está contido no de a
+    std::vector<std::vector<int> > children(count);
+    for (int b : cfg->order) {
+        if (cfg->blocks[b].idom >= 0) children[cfg->blocks[b].idom].push_back(b);
+    }
+    int clock = 0;
+    std::vector<std::pair<int, int> > stack;
+    stack.push_back(std::make_pair(entry, 0));
+    cfg->blocks[entry].domPre = clock++;
+    while (!stack.empty()) {
+        std::pair<int, int>& top = stack.back();
+        if (top.second < (int)children[top.first].size()) {
+            int child = children[top.first][top.second++];
+            cfg->blocks[child].domPre = clock++;
+            stack.push_back(std::make_pair(child, 0));
+        } else {
+            cfg->blocks[top.first].domPost = clock++;
+            stack.pop_back();
+        }
+    }
+}
+
+bool cfgDominates(const CFG* cfg, int a, int b) {
+    const BasicBlock& x = cfg->blocks[a];
+    const BasicBlock& y = cfg->blocks[b];
+    if (x.rpo < 0 || y.rpo < 0) return false;
+    return x.domPre <= y.domPre && y.domPost <= x.domPost;
+}
+
+void cfgFindLoops(CFG* cfg) {
+    int count = (int)cfg->blocks.size();
+    cfg->loops.clear();
+    for (int b = 0; b < count; b++) {
+        cfg->blocks[b].loop = -1;
+    }
+
+    // Cabeçalhos em pós-ordem da árvore de dominadores: laços internos primeiro
+    std::vector<int> headers(2 * count, -1);
+    for (int b : cfg->order) headers[cfg->blocks[b].domPost] = b;
+
+    std::vector<int> work;
+    for (int header : headers) {
+        if (header < 0) continue;
+        for (int p : cfg->blocks[header].pred) {
+            if (cfgDominates(cfg, header, p)) work.push_back(p);
+        }
+        if (work.empty()) continue;
+
+        int loop = (int)cfg->loops.size();
+        Loop l;
+        l.header = header;
+        l.parent = -1;
+        l.depth = 0;
+        cfg->loops.push_back(l);
+
+        // Sobe pelos predecessores a partir das arestas de volta até o cabeçalho;
+        // um laço interno já encontrado é atravessado direto pelo seu cabeçalho
+        while (!work.empty()) {
+            int b = work.back();
+            work.pop_back();
+            if (cfg->blocks[b].rpo < 0) continue;
+
+            int inner = cfg->blocks[b].loop;
+            if (inner < 0) {
+                cfg->blocks[b].loop = loop;
+                if (b == header) continue;
+                for (int p : cfg->blocks[b].pred) work.push_back(p);
+                continue;
+            }
+            while (cfg->loops[inner].parent >= 0) inner = cfg->loops[inner].parent;
+            if (inner == loop) continue;
+            cfg->loops[inner].parent = loop;
+            for (int p : cfg->blocks[cfg->loops[inner].header].pred) work.push_back(p);
+        }
+    }
+
+    // Laços externos são criados depois dos internos
+    for (int i = (int)cfg->loops.size() - 1; i >= 0; i--) {
+        Loop& l = cfg->loops[i];
+        l.depth = l.parent < 0 ? 1 : cfg->loops[l.parent].depth + 1;
+    }
+}
+
+int cfgLoopDepth(const CFG* cfg, int block) {
+    int loop = cfg->blocks[block].loop;
+    return loop < 0 ? 0 : cfg->loops[loop].depth;
+}
+
+// Imprime os blocos com sucessores, dominador imediato e profundidade de laço
+void cfgPrint(const CFG* cfg, FILE* out) {
+    fprintf(out, "CFG %s: %d blocks, %d loops\n", cfg->function->text.c_str(),
+            (int)cfg->blocks.size(), (int)cfg->loops.size());
+    for (const BasicBlock& block : cfg->blocks) {
+        fprintf(out, "  B%d: idom=%d depth=%d succ=", block.id, block.idom, cfgLoopDepth(cfg, block.id));
+        for (size_t i = 0; i < block.succ.size(); i++) {
+            fprintf(out, i ? ",%d" : "%d", block.succ[i]);
+        }
+        fprintf(out, block.rpo < 0 ? " (unreachable)\n" : "\n");
+    }
+}
@@ -0,0 +1,60 @@
+//
+// cfg.hpp - Grafo de fluxo de controle, dominadores e laços sobre as TACs
+//
+
+#ifndef CFG_HPP
+#define CFG_HPP
+
+#include <stdio.h>
+#include <vector>
+#include "tacs.hpp"
+
+// Bloco básico: sequência first..last de TACs sem desvios no meio
+typedef struct basic_block {
+    int id;
+    TAC* first;
+    TAC* last;
+    std::vector<int> succ;      // sucessores
+    std::vector<int> pred;      // predecessores
+    int rpo;                    // posição na pós-ordem reversa (-1: inalcançável)
+    int idom;                   // dominador imediato (-1 na entrada e nos inalcançáveis)
+    int domPre, domPost;        // numeração da árvore de dominadores (consulta em O(1))
+    int loop;                   // laço mais interno que contém o bloco (-1: nenhum)
+} BasicBlock;
+
+// Laço natural: blocos dominados pelo cabeçalho que alcançam uma aresta de volta
+typedef struct {
+    int header;                 // bloco cabeçalho
+    int parent;                 // laço imediatamente externo (-1: nenhum)
+    int depth;                  // profundidade de aninhamento (1: mais externo)
+} Loop;
+
+// CFG de uma função (BEGINFUN..ENDFUN). O bloco 0 é a entrada
+typedef struct {
+    Symbol* function;
+    TAC* begin;                 // TAC_BEGINFUN
+    TAC* end;                   // TAC_ENDFUN
+    std::vector<BasicBlock> blocks;
+    std::vector<int> order;     // blocos alcançáveis em pós-ordem reversa
+    std::vector<Loop> loops;
+    int labelBase;              // menor número de label da função
+    std::vector<int> labelBlock; // bloco de cada label, indexado por número - labelBase
+} CFG;
+
+// Constrói o CFG da função que começa em begin (TAC_BEGINFUN), com
+// dominadores e laços já calculados
+CFG* cfgBuild(TAC* begin);
+void cfgFree(CFG* cfg);
+
+// Recalcula dominadores e laços (após mudanças nas arestas)
+void cfgComputeDominators(CFG* cfg);
+void cfgFindLoops(CFG* cfg);
+
+// Consultas
+bool cfgDominates(const CFG* cfg, int a, int b);
+int cfgLoopDepth(const CFG* cfg, int block);
+int cfgBlockOf(const CFG* cfg, Symbol* label);
+
+void cfgPrint(const CFG* cfg, FILE* out);
+
+#endif // CFG_HPP
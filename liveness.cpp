@@ -0,0 +1,251 @@
+//
+// liveness.cpp - Análise de vida (liveness) das variáveis e temporários de uma função
+//
+// Análise para trás sobre os blocos do CFG. Os operandos da função são
+// numerados de forma densa (temporários pelo número, variáveis pelo id, sem
+// mapas de Symbol*), e cada conjunto é um vetor de palavras de 64 bits. A
+// lista de trabalho começa na pós-ordem do CFG, que é a pós-ordem reversa do
+// grafo invertido: cada bloco tende a ser visto depois dos seus sucessores.
+//
+// Variáveis são globais na linguagem: ficam vivas na saída da função e em
+// toda chamada, que pode lê-las.
+//
+
+#include "liveness.hpp"
+#include "parser.tab.hpp"
+#include <climits>
+#include <ctime>
+#include <deque>
+
+// Variável ou temporário (literais e funções não participam da análise)
+static bool livenessTracked(Symbol* s) {
+    if (!s) return false;
+    if (s->nature == SYMBOL_TEMP) return true;
+    return s->type == TK_IDENTIFIER && (s->nature == SYMBOL_SCALAR || s->nature == SYMBOL_VECTOR);
+}
+
+int livenessIndex(const Liveness* live, Symbol* s) {
+    if (!livenessTracked(s)) return -1;
+    if (s->nature == SYMBOL_TEMP) {
+        int k = s->number - live->tempBase;
+        return k >= 0 && k < (int)live->tempIndex.size() ? live->tempIndex[k] : -1;
+    }
+    int k = s->id - live->varBase;
+    return k >= 0 && k < (int)live->varIndex.size() ? live->varIndex[k] : -1;
+}
+
+const uint64_t* livenessIn(const Liveness* live, int block) {
+    return &live->in[(size_t)block * live->words];
+}
+
+const uint64_t* livenessOut(const Liveness* live, int block) {
+    return &live->out[(size_t)block * live->words];
+}
+
+static inline void bitSet(uint64_t* set, int index) {
+    set[index >> 6] |= (uint64_t)1 << (index & 63);
+}
+
+static inline void bitClear(uint64_t* set, int index) {
+    set[index >> 6] &= ~((uint64_t)1 << (index & 63));
+}
+
+void livenessStep(const Liveness* live, TAC* tac, uint64_t* set) {
+    TacOperands ops = tacOperands(tac);
+    int def = livenessIndex(live, ops.def);
+    if (def >= 0) bitClear(set, def);
+    for (int k = 0; k < 3; k++) {
+        int use = livenessIndex(live, ops.use[k]);
+        if (use >= 0) bitSet(set, use);
+    }
+    // As variáveis estão entre os blockCount primeiros índices
+    if (ops.usesGlobals) {
+        for (int w = 0; w < live->words; w++) set[w] |= live->globals[w];
+    }
+}
+
+// Numera os operandos da função: faixas de números de temporários e de ids
+// de variáveis, depois um índice por operando distinto. Só operandos lidos
+// num bloco antes de serem escritos nele (e as variáveis) podem estar vivos
+// entre blocos: eles recebem os primeiros índices, e os conjuntos dos blocos
+// têm só esses bits. Temporários locais a um bloco ficam no fim
+static void livenessNumber(Liveness* live) {
+    const CFG* cfg = live->cfg;
+    int minTemp = INT_MAX, maxTemp = -1, minVar = INT_MAX, maxVar = -1;
+
+    for (TAC* tac = cfg->begin; ; tac = tac->next) {
+        void* operands[3] = {tac->res, tac->op1, tac->op2};
+        for (void* operand : operands) {
+            Symbol* s = (Symbol*)operand;
+            if (!livenessTracked(s)) continue;
+            if (s->nature == SYMBOL_TEMP) {
+                if (s->number < minTemp) minTemp = s->number;
+                if (s->number > maxTemp) maxTemp = s->number;
+            } else {
+                if (s->id < minVar) minVar = s->id;
+                if (s->id > maxVar) maxVar = s->id;
+            }
+        }
+        if (tac == cfg->end) break;
+    }
+
+    live->tempBase = maxTemp < 0 ? 0 : minTemp;
+    live->tempIndex.assign(maxTemp < 0 ? 0 : maxTemp - minTemp + 1, -1);
+    live->varBase = maxVar < 0 ? 0 : minVar;
+    live->varIndex.assign(maxVar < 0 ? 0 : maxVar - minVar + 1, -1);
+
+    // Índices provisórios, na ordem de aparição
+    for (TAC* tac = cfg->begin; ; tac = tac->next) {
+        void* operands[3] = {tac->res, tac->op1, tac->op2};
+        for (void* operand : operands) {
+            Symbol* s = (Symbol*)operand;
+            if (!livenessTracked(s)) continue;
+            int& index = s->nature == SYMBOL_TEMP ? live->tempIndex[s->number - live->tempBase]
+                                                  : live->varIndex[s->id - live->varBase];
+            if (index >= 0) continue;
+            index = (int)live->operands.size();
+            live->operands.push_back(s);
+        }
+        if (tac == cfg->end) break;
+    }
+    live->count = (int)live->operands.size();
+
+    // Operandos lidos antes de escritos em algum bloco
+    std::vector<char> global(live->count, 0);
+    std::vector<int> definedIn(live->count, -1);
+    for (int i = 0; i < live->count; i++) {
+        if (live->operands[i]->nature != SYMBOL_TEMP) global[i] = 1;
+    }
+    for (const BasicBlock& block : cfg->blocks) {
+        for (TAC* tac = block.first; ; tac = tac->next) {
+            TacOperands ops = tacOperands(tac);
+            for (int k = 0; k < 3; k++) {
+                int u = livenessIndex(live, ops.use[k]);
+                if (u >= 0 && definedIn[u] != block.id) global[u] = 1;
+            }
+            int d = livenessIndex(live, ops.def);
+            if (d >= 0) definedIn[d] = block.id;
+            if (tac == block.last) break;
+        }
+    }
+
+    // Índices definitivos: primeiro os que podem estar vivos entre blocos
+    std::vector<Symbol*> operands;
+    operands.reserve(live->count);
+    for (int pass = 1; pass >= 0; pass--) {
+        for (int i = 0; i < live->count; i++) {
+            if (global[i] == pass) operands.push_back(live->operands[i]);
+        }
+        if (pass == 1) live->blockCount = (int)operands.size();
+    }
+    live->operands.swap(operands);
+    for (int i = 0; i < live->count; i++) {
+        Symbol* s = live->operands[i];
+        if (s->nature == SYMBOL_TEMP) live->tempIndex[s->number - live->tempBase] = i;
+        else live->varIndex[s->id - live->varBase] = i;
+    }
+
+    live->words = (live->blockCount + 63) / 64;
+    live->stepWords = (live->count + 63) / 64;
+    live->globals.assign(live->stepWords, 0);
+    for (int i = 0; i < live->count; i++) {
+        if (live->operands[i]->nature != SYMBOL_TEMP) bitSet(&live->globals[0], i);
+    }
+}
+
+static LivenessStats stats;
+
+LivenessStats livenessGetStats(void) {
+    return stats;
+}
+
+Liveness* livenessCompute(const CFG* cfg) {
+    clock_t start = clock();
+    Liveness* live = new Liveness();
+    live->cfg = cfg;
+    live->visits = 0;
+    livenessNumber(live);
+
+    int blocks = (int)cfg->blocks.size();
+    int words = live->words;
+    live->use.assign((size_t)blocks * words, 0);
+    live->def.assign((size_t)blocks * words, 0);
+    live->in.assign((size_t)blocks * words, 0);
+    live->out.assign((size_t)blocks * words, 0);
+
+    // use/def de cada bloco: percorre as TACs de trás para frente
+    for (int b = 0; b < blocks; b++) {
+        const BasicBlock& block = cfg->blocks[b];
+        uint64_t* use = &live->use[(size_t)b * words];
+        uint64_t* def = &live->def[(size_t)b * words];
+        for (TAC* tac = block.last; ; tac = tac->prev) {
+            TacOperands ops = tacOperands(tac);
+            int d = livenessIndex(live, ops.def);
+            if (d >= 0 && d < live->blockCount) {
+                bitSet(def, d);
+                bitClear(use, d);
+            }
+            for (int k = 0; k < 3; k++) {
+                int u = livenessIndex(live, ops.use[k]);
+                if (u >= 0 && u < live->blockCount) bitSet(use, u);
+            }
+            if (ops.usesGlobals) {
+                for (int w = 0; w < words; w++) use[w] |= live->globals[w];
+            }
+            if (tac == block.first) break;
+        }
+    }
+
+    // Ponto fixo: out = união dos in dos sucessores, in = use + (out - def)
+    std::deque<int> work;
+    std::vector<char> queued(blocks, 0);
+    for (int i = (int)cfg->order.size() - 1; i >= 0; i--) {
+        work.push_back(cfg->order[i]);
+        queued[cfg->order[i]] = 1;
+    }
+    while (!work.empty()) {
+        int b = work.front();
+        work.pop_front();
+        queued[b] = 0;
+        live->visits++;
+
+        uint64_t* out = &live->out[(size_t)b * words];
+        uint64_t* in = &live->in[(size_t)b * words];
+        const uint64_t* use = &live->use[(size_t)b * words];
+        const uint64_t* def = &live->def[(size_t)b * words];
+        for (int s : cfg->blocks[b].succ) {
+            const uint64_t* succIn = &live->in[(size_t)s * words];
+            for (int w = 0; w < words; w++) out[w] |= succIn[w];
+        }
+
+        bool changed = false;
+        for (int w = 0; w < words; w++) {
+            uint64_t value = use[w] | (out[w] & ~def[w]);
+            if (value != in[w]) {
+                in[w] = value;
+                changed = true;
+            }
+        }
+        if (!changed) continue;
+        for (int p : cfg->blocks[b].pred) {
+            if (queued[p] || cfg->blocks[p].rpo < 0) continue;
+            queued[p] = 1;
+            work.push_back(p);
+        }
+    }
+
+    long bytes = 4L * blocks * words * (long)sizeof(uint64_t);
+    stats.runs++;
+    stats.seconds += (double)(clock() - start) / CLOCKS_PER_SEC;
+    stats.visits += live->visits;
+    if (bytes > stats.maxBytes) {
+        stats.maxBytes = bytes;
+        stats.maxBlocks = blocks;
+        stats.maxOperands = live->blockCount;
+    }
+    return live;
+}
+
+void livenessFree(Liveness* live) {
+    delete live;
+}
@@ -0,0 +1,64 @@
+//
+// liveness.hpp - Análise de vida (liveness) das variáveis e temporários de uma função
+//
+
+#ifndef LIVENESS_HPP
+#define LIVENESS_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "cfg.hpp"
+
+// Conjuntos de vida por bloco, em bitsets densos: cada variável ou
+// temporário da função recebe um índice compacto. Os conjuntos dos blocos
+// cobrem só os blockCount primeiros índices (operandos que podem estar vivos
+// entre blocos); conjuntos usados com livenessStep cobrem todos
+typedef struct {
+    const CFG* cfg;
+    int count;                      // operandos numerados
+    int blockCount;                 // operandos que podem estar vivos entre blocos
+    int words;                      // palavras de 64 bits por conjunto de bloco
+    int stepWords;                  // palavras de 64 bits por conjunto de livenessStep
+    std::vector<Symbol*> operands;  // operando de cada índice
+    int tempBase;                   // menor número de temporário da função
+    std::vector<int> tempIndex;     // índice de cada temporário (por número - tempBase)
+    int varBase;                    // menor id de variável da função
+    std::vector<int> varIndex;      // índice de cada variável (por id - varBase)
+    std::vector<uint64_t> globals;  // variáveis (vivas em chamadas e na saída)
+    std::vector<uint64_t> use;      // usados antes de definidos no bloco
+    std::vector<uint64_t> def;      // definidos no bloco
+    std::vector<uint64_t> in;       // vivos na entrada do bloco
+    std::vector<uint64_t> out;      // vivos na saída do bloco
+    int visits;                     // blocos processados até o ponto fixo
+} Liveness;
+
+Liveness* livenessCompute(const CFG* cfg);
+void livenessFree(Liveness* live);
+
+// Estatísticas acumuladas das chamadas de livenessCompute (impressas com -stats)
+typedef struct {
+    long runs;          // chamadas
+    double seconds;     // tempo total
+    long visits;        // blocos processados até os pontos fixos
+    long maxBytes;      // maior memória de conjuntos de bloco numa chamada
+    int maxBlocks;      // blocos da função dessa chamada
+    int maxOperands;    // operandos vivos entre blocos dessa chamada
+} LivenessStats;
+
+LivenessStats livenessGetStats(void);
+
+// Índice do operando (-1 se não for variável nem temporário da função)
+int livenessIndex(const Liveness* live, Symbol* s);
+
+// Conjuntos de um bloco
+const uint64_t* livenessIn(const Liveness* live, int block);
+const uint64_t* livenessOut(const Liveness* live, int block);
+
+static inline bool livenessTest(const uint64_t* set, int index) {
+    return index >= 0 && (set[index >> 6] >> (index & 63)) & 1;
+}
+
+// Atualiza o conjunto (stepWords palavras, vivos depois da TAC) para antes da TAC
+void livenessStep(const Liveness* live, TAC* tac, uint64_t* set);
+
+#endif // LIVENESS_HPP
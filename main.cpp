@@ -4,6 +4,9 @@
 #include "symbols.hpp"
 #include "ast.h"
 #include "tacs.hpp"
+#include "asm.hpp"
+#include "liveness.hpp"
+#include "opt.hpp"
 
 FILE* ast_output_file = nullptr;
 extern AST* ast_root;
@@ -12,13 +15,12 @@ extern FILE *yyin;
 extern int yyparse(void);
 extern void yyrestart(FILE*);
 
-// Função para realizar a verificação semântica da AST
-void semanticAnalysis(AST* node) {
-    if (!node) return;
-    
+// Verificação semântica de um único nó
+static void semanticCheckNode(AST* node) {
     // Verificar o tipo de nó e realizar a verificação semântica apropriada
     switch (node->type) {
         case AST_VAR_DECL:
+        case AST_VEC_DECL:
         case AST_FUNC_DECL:
             checkDeclaration(node);
             break;
@@ -28,14 +30,16 @@ void semanticAnalysis(AST* node) {
             break;
             
         case AST_FUNC_CALL:
-            checkFunctionCall(node);
+            // O tipo da chamada inclui a verificação dos argumentos
+            getExpressionType(node);
             break;
             
         case AST_OP:
-            if (node->symbol && strcmp((const char*)node->symbol, "INDEX") == 0) {
+            if (node->op == OP_INDEX) {
                 checkVectorIndex(node);
             } else {
                 // Para outros operadores, obter o tipo da expressão já faz as verificações
+                // (normalmente já calculado pelo comando que contém a expressão)
                 getExpressionType(node);
             }
             break;
@@ -57,18 +61,20 @@ void semanticAnalysis(AST* node) {
             // Para outros tipos de nós, não há verificação específica
             break;
     }
+}
+
+// Função para realizar a verificação semântica da AST: visita cada nó em
+// pré-ordem (nó, filhos, irmãos) com a travessia iterativa da AST
+void semanticAnalysis(AST* node) {
+    AstWalker walker;
+    AstStep step;
     
-    // Processar filhos recursivamente
-    for (int i = 0; i < 4; i++) {
-        if (node->son[i]) {
-            semanticAnalysis(node->son[i]);
+    astWalkBegin(&walker, node);
+    while (astWalkNext(&walker, &step)) {
+        if (!step.post) {
+            semanticCheckNode(step.node);
         }
     }
-    
-    // Processar irmãos
-    if (node->next) {
-        semanticAnalysis(node->next);
-    }
 }
 
 int main(int argc, char **argv) {
@@ -79,8 +85,29 @@ int main(int argc, char **argv) {
     // 3: erro de sintaxe
     // 4: existência de um ou mais erros semânticos
     
+    // -O: otimiza as TACs antes de imprimi-las e de gerar o assembly
+    // -inline=N: orçamento do inlining feito por -O (0 desliga)
+    // -stats: imprime em stderr o uso de memória da AST, o custo da análise
+    // de vida, o resumo de cada passo de -O e a alocação de registradores
+    bool optimize_code = false;
+    bool print_stats = false;
+    while (argc >= 2) {
+        if (strcmp(argv[1], "-O") == 0) {
+            optimize_code = true;
+        } else if (strcmp(argv[1], "-stats") == 0) {
+            print_stats = true;
+            opt_stats = true;
+        } else if (strncmp(argv[1], "-inline=", 8) == 0) {
+            opt_inline_budget = atoi(argv[1] + 8);
+        } else {
+            break;
+        }
+        argv++;
+        argc--;
+    }
+    
     if (argc < 2) {
-        fprintf(stderr, "Call: ./etapa4 input_file [output_file]\n");
+        fprintf(stderr, "Call: ./etapa5 [-O] [-inline=N] [-stats] input_file [output_file [asm_file]]\n");
         exit(1);  // Código 1: arquivo não informado
     }
 
@@ -112,18 +139,36 @@ int main(int argc, char **argv) {
         exit(3);  // Código 3: erro de sintaxe
     }
     
+    if (print_stats) {
+        AstArenaStats arena = astArenaGetStats();
+        fprintf(stderr, "AST: %ld nodes, %ld bytes in %ld chunks\n", arena.nodes, arena.bytes, arena.chunks);
+    }
+    
     printf("\nAnálise semântica...\n\n");
     // Realizar análise semântica
     semanticAnalysis(ast_root);
     
     // Decompilação da AST
+    TAC* code = NULL;
     if (ast_root) {
         // Usar a nova função simplificada para descompilação
         astDecompileSimple(ast_root, out);
         
         // Etapa 5: Geração de código intermediário (TACs)
         fprintf(stderr, "\nGenerating intermediate code (TACs)...\n\n");
-        TAC* code = generateCode(ast_root);
+        code = generateCode(ast_root);
+        
+        // Otimizações só sobre programas semanticamente corretos
+        if (code && optimize_code && getSemanticErrorCount() == 0) {
+            fprintf(stderr, "Optimizing intermediate code...\n");
+            code = optimize(code);
+            
+            LivenessStats live = livenessGetStats();
+            if (print_stats && live.runs > 0) {
+                fprintf(stderr, "Liveness: %ld runs, %.1f ms, %ld block visits; largest %d blocks x %d operands, %ld bytes\n",
+                        live.runs, live.seconds * 1000, live.visits, live.maxBlocks, live.maxOperands, live.maxBytes);
+            }
+        }
         
         // Imprimir TACs
         if (code) {
@@ -142,6 +187,10 @@ int main(int argc, char **argv) {
     fclose(yyin);
     if (out != stdout) fclose(out);
     
+    // A AST não é mais necessária: libera a arena inteira
+    astFree(ast_root);
+    ast_root = NULL;
+    
     // Imprimir tabela de símbolos
     symbolPrintTable();
 
@@ -152,6 +201,17 @@ int main(int argc, char **argv) {
         exit(4);  // Código 4: existência de erros semânticos
     }
     
+    // Geração de assembly x86-64, se pedida (terceiro argumento)
+    if (argc >= 4) {
+        FILE* asm_file = fopen(argv[3], "w");
+        if (!asm_file) {
+            fprintf(stderr, "Cannot open assembly output file %s\n", argv[3]);
+            exit(2);
+        }
+        asmGenerate(code, asm_file, print_stats);
+        fclose(asm_file);
+    }
+    
     fprintf(stderr, "\nCompilation successful.\n");
     return 0;  // Código 0: sucesso
 }
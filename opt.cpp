@@ -0,0 +1,3140 @@
+//
+// opt.cpp - Otimizações sobre as TACs
+//
+// Passos aplicados por optimize, em ordem, a cada função (BEGINFUN..ENDFUN)
+// e, quando fazem sentido sem CFG, ao código global (uma sequência sem
+// desvios executada antes de main):
+//
+//  - chamadas recursivas em posição de cauda viram saltos ao início;
+//  - expansão de funções pequenas no lugar das chamadas (inlining);
+//  - dobramento e propagação de constantes;
+//  - propagação de constantes condicional esparsa (SCCP) sobre a forma SSA;
+//  - numeração de valores local (eliminação de subexpressões comuns);
+//  - eliminação de código morto: blocos inalcançáveis, definições sem uso,
+//    desvios redundantes e labels sem referência;
+//  - análise de intervalos, que dispensa a verificação de limites dos
+//    acessos a vetor com índice provado;
+//  - movimentação de código invariante para fora de laços;
+//  - vetorização (SSE2/AVX2) de laços que combinam vetores elemento a elemento;
+//  - redução de força de variáveis de indução que indexam vetores;
+//  - peephole: uma tabela de regras locais sobre desvios, labels e cópias,
+//    que também junta comparação e IFZ num desvio condicional (TAC_IFNLT...).
+//
+// Variáveis são globais na linguagem: toda chamada pode lê-las e escrevê-las.
+// Com opt_stats, cada passo imprime em stderr um resumo por função.
+//
+
+#include "opt.hpp"
+#include "asm.hpp"
+#include "cfg.hpp"
+#include "liveness.hpp"
+#include "ssa.hpp"
+#include "parser.tab.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+bool opt_stats = false;
+
+// Dobramento e propagação de constantes. As operações com operandos
+// literais são calculadas com as mesmas regras do gerador de assembly:
+// inteiros de 64 bits, ponto flutuante se um operando é real ou se a divisão
+// produz real (getExpressionType), e truncamento ao tamanho da variável
+// quando o valor é guardado nela. Os valores seguem pelos MOVE dentro de cada
+// bloco. Entre blocos, um temporário cujas definições são todas o mesmo
+// literal é trocado por ele em todos os usos; uma variável nessa condição só
+// é propagada onde uma análise para frente (interseção nos predecessores)
+// garante que ela recebeu o literal sem uma chamada no caminho
+
+// Valor constante como fica em registrador: inteiro de 64 bits ou double
+typedef struct {
+    bool real;
+    long i;
+    double r;
+} ConstValue;
+
+// Valores por operando: temporários pelo número, variáveis pelo id. Uma
+// entrada só vale com o carimbo corrente, e trocar de carimbo esquece todas
+typedef struct {
+    std::vector<ConstValue> tempValue, varValue;
+    std::vector<int> tempStamp, varStamp;
+    int tempEpoch, varEpoch;
+} ConstTable;
+
+// Definições constantes de uma função: valor da primeira definição e
+// operandos com alguma definição que não é esse mesmo literal
+typedef struct {
+    ConstTable value;
+    ConstTable varies;
+} ConstDefs;
+
+typedef struct {
+    int folded;         // operações calculadas
+    int propagated;     // operandos trocados por literais
+    int removed;        // TACs de temporários sem uso retiradas
+} ConstStats;
+
+// Número de usos de cada temporário (zerado depois de cada região)
+static std::vector<int> temp_uses;
+
+// Bit de cada variável candidata na análise entre blocos (-1: nenhum)
+static std::vector<int> var_bit;
+
+static void constInit(ConstTable* table) {
+    table->tempEpoch = 1;
+    table->varEpoch = 1;
+}
+
+static void constForgetAll(ConstTable* table) {
+    table->tempEpoch++;
+    table->varEpoch++;
+}
+
+// Escalar numérico ou temporário
+static bool constTracked(Symbol* s) {
+    if (!s || s->dataType == DATATYPE_STRING) return false;
+    if (s->nature == SYMBOL_TEMP) return true;
+    return s->type == TK_IDENTIFIER && s->nature == SYMBOL_SCALAR;
+}
+
+static bool constGet(const ConstTable* table, Symbol* s, ConstValue* value) {
+    if (!constTracked(s)) return false;
+    if (s->nature == SYMBOL_TEMP) {
+        int key = s->number;
+        if (key >= (int)table->tempStamp.size() || table->tempStamp[key] != table->tempEpoch) return false;
+        *value = table->tempValue[key];
+    } else {
+        int key = s->id;
+        if (key >= (int)table->varStamp.size() || table->varStamp[key] != table->varEpoch) return false;
+        *value = table->varValue[key];
+    }
+    return true;
+}
+
+static void constSet(ConstTable* table, Symbol* s, ConstValue value) {
+    bool temp = s->nature == SYMBOL_TEMP;
+    std::vector<int>& stamp = temp ? table->tempStamp : table->varStamp;
+    std::vector<ConstValue>& values = temp ? table->tempValue : table->varValue;
+    int key = temp ? s->number : s->id;
+    if (key >= (int)stamp.size()) {
+        int size = temp ? tacTempCount() : symbolCount();
+        stamp.resize(size, 0);
+        values.resize(size);
+    }
+    stamp[key] = temp ? table->tempEpoch : table->varEpoch;
+    values[key] = value;
+}
+
+static void constForget(ConstTable* table, Symbol* s) {
+    if (!constTracked(s)) return;
+    bool temp = s->nature == SYMBOL_TEMP;
+    std::vector<int>& stamp = temp ? table->tempStamp : table->varStamp;
+    int key = temp ? s->number : s->id;
+    if (key < (int)stamp.size()) stamp[key] = 0;
+}
+
+static bool constSame(ConstValue a, ConstValue b) {
+    return a.real == b.real && a.i == b.i && memcmp(&a.r, &b.r, sizeof(double)) == 0;
+}
+
+// Valor de um literal numérico (inteiros em base 10, char pelo código)
+static bool constOfLiteral(Symbol* s, ConstValue* value) {
+    if (!s) return false;
+    value->real = false;
+    value->i = 0;
+    value->r = 0;
+    switch (s->type) {
+        case LIT_INT:
+            value->i = strtol(s->text.c_str(), NULL, 10);
+            return true;
+        case LIT_CHAR:
+            value->i = (unsigned char)s->text[1];
+            return true;
+        case LIT_REAL:
+            value->real = true;
+            value->r = strtod(s->text.c_str(), NULL);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Valor que o operando s guarda ao receber value: conversão entre inteiro e
+// real e, em variáveis, truncamento ao tamanho em memória
+static bool constStore(Symbol* s, ConstValue value, ConstValue* stored) {
+    stored->real = s->dataType == DATATYPE_REAL;
+    stored->i = 0;
+    stored->r = 0;
+    if (stored->real) {
+        stored->r = value.real ? value.r : (double)value.i;
+        return true;
+    }
+
+    long i = value.i;
+    if (value.real) {
+        // Fora da faixa o cvttsd2si não tem um valor que valha reproduzir
+        if (!(value.r > -9.2e18 && value.r < 9.2e18)) return false;
+        i = (long)value.r;
+    }
+    if (s->nature != SYMBOL_TEMP) {
+        switch (s->dataType) {
+            case DATATYPE_BYTE:
+            case DATATYPE_CHAR:
+            case DATATYPE_BOOLEAN:
+                i = (unsigned char)i;
+                break;
+            default:
+                i = (int)i;
+                break;
+        }
+    }
+    stored->i = i;
+    return true;
+}
+
+// Literal com o valor de um operando do tipo type, da mesma classe que ele
+// (real, char impresso com %c ou inteiro). NULL se não houver literal
+static Symbol* constLiteral(ConstValue value, DataType type) {
+    char text[64];
+    if (type == DATATYPE_REAL) {
+        // Menor precisão que reproduz o double
+        for (int precision = 1; precision <= 17; precision++) {
+            snprintf(text, sizeof(text), "%.*g", precision, value.r);
+            if (strtod(text, NULL) == value.r) break;
+        }
+        if (!strpbrk(text, ".e")) strcat(text, ".0");
+        return symbolInsert(LIT_REAL, text);
+    }
+    if (type == DATATYPE_CHAR) {
+        if (value.i < 0 || value.i > 255) return NULL;
+        text[0] = '\'';
+        text[1] = (char)value.i;
+        text[2] = '\'';
+        return symbolInsert(LIT_CHAR, text, 3);
+    }
+    snprintf(text, sizeof(text), "%ld", value.i);
+    return symbolInsert(LIT_INT, text);
+}
+
+// Calcula a op b. realDiv: a divisão produz real (tipo do resultado)
+static bool constFold(TacType type, ConstValue a, ConstValue b, bool realDiv, ConstValue* result) {
+    result->real = false;
+    result->i = 0;
+    result->r = 0;
+
+    if (a.real || b.real || (type == TAC_DIV && realDiv)) {
+        double x = a.real ? a.r : (double)a.i;
+        double y = b.real ? b.r : (double)b.i;
+        double r;
+        switch (type) {
+            case TAC_ADD: r = x + y; break;
+            case TAC_SUB: r = x - y; break;
+            case TAC_MUL: r = x * y; break;
+            case TAC_DIV: r = x / y; break;
+            case TAC_LT: result->i = x < y; return true;
+            case TAC_GT: result->i = x > y; return true;
+            case TAC_LE: result->i = x <= y; return true;
+            case TAC_GE: result->i = x >= y; return true;
+            case TAC_EQ: result->i = x == y; return true;
+            case TAC_NE: result->i = x != y; return true;
+            default: return false;
+        }
+        // Divisão por zero e estouros ficam para a execução
+        if (!std::isfinite(r)) return false;
+        result->real = true;
+        result->r = r;
+        return true;
+    }
+
+    // Aritmética inteira com a volta de 64 bits das instruções
+    unsigned long x = (unsigned long)a.i, y = (unsigned long)b.i;
+    switch (type) {
+        case TAC_ADD: result->i = (long)(x + y); break;
+        case TAC_SUB: result->i = (long)(x - y); break;
+        case TAC_MUL: result->i = (long)(x * y); break;
+        case TAC_DIV:
+            if (b.i == 0 || (b.i == -1 && a.i == LONG_MIN)) return false;
+            result->i = a.i / b.i;
+            break;
+        case TAC_LT: result->i = a.i < b.i; break;
+        case TAC_GT: result->i = a.i > b.i; break;
+        case TAC_LE: result->i = a.i <= b.i; break;
+        case TAC_GE: result->i = a.i >= b.i; break;
+        case TAC_EQ: result->i = a.i == b.i; break;
+        case TAC_NE: result->i = a.i != b.i; break;
+        default: return false;
+    }
+    return true;
+}
+
+// Valor conhecido do operando: definido antes no bloco ou temporário que só
+// recebe um literal
+static bool optKnownValue(Symbol* s, const ConstTable* known, const ConstDefs* defs, ConstValue* value) {
+    if (constGet(known, s, value)) return true;
+    if (!defs || !s || s->nature != SYMBOL_TEMP) return false;
+    ConstValue other;
+    return constGet(&defs->value, s, value) && !constGet(&defs->varies, s, &other);
+}
+
+// Troca os operandos conhecidos por literais, dobra a operação se puder e
+// registra o valor que a TAC define
+static void optConstantsTac(TAC* tac, ConstTable* known, const ConstDefs* defs, ConstStats* stats) {
+    void** fields[2];
+    int count = tacUseFields(tac, fields);
+    for (int k = 0; k < count; k++) {
+        Symbol* s = (Symbol*)*fields[k];
+        ConstValue value;
+        if (!optKnownValue(s, known, defs, &value)) continue;
+        Symbol* literal = constLiteral(value, s->dataType);
+        if (!literal) continue;
+        *fields[k] = literal;
+        stats->propagated++;
+    }
+
+    Symbol* res = (Symbol*)tac->res;
+    if (tac->type >= TAC_ADD && tac->type <= TAC_NE) {
+        ConstValue a, b, result, stored;
+        if (constOfLiteral((Symbol*)tac->op1, &a) && constOfLiteral((Symbol*)tac->op2, &b) &&
+            constFold(tac->type, a, b, res->dataType == DATATYPE_REAL, &result) &&
+            constStore(res, result, &stored)) {
+            Symbol* literal = constLiteral(stored, res->dataType);
+            if (literal) {
+                tac->type = TAC_MOVE;
+                tac->op1 = literal;
+                tac->op2 = NULL;
+                stats->folded++;
+            }
+        }
+    }
+
+    // A função chamada pode escrever qualquer variável
+    if (tac->type == TAC_CALL) known->varEpoch++;
+
+    TacOperands ops = tacOperands(tac);
+    if (!ops.def) return;
+    ConstValue value, stored;
+    if (tac->type == TAC_MOVE && constTracked(ops.def) && constOfLiteral((Symbol*)tac->op1, &value) &&
+        constStore(ops.def, value, &stored))
+        constSet(known, ops.def, stored);
+    else
+        constForget(known, ops.def);
+}
+
+// Registra as definições de cada operando da função
+static void optCollectDefs(const CFG* cfg, ConstDefs* defs) {
+    constForgetAll(&defs->value);
+    constForgetAll(&defs->varies);
+    for (TAC* tac = cfg->begin; ; tac = tac->next) {
+        Symbol* def = tacOperands(tac).def;
+        if (constTracked(def)) {
+            ConstValue value, stored = {false, 0, 0}, first;
+            bool literal = tac->type == TAC_MOVE && constOfLiteral((Symbol*)tac->op1, &value) &&
+                           constStore(def, value, &stored);
+            if (!literal)
+                constSet(&defs->varies, def, stored);
+            else if (!constGet(&defs->value, def, &first))
+                constSet(&defs->value, def, stored);
+            else if (!constSame(first, stored))
+                constSet(&defs->varies, def, stored);
+        }
+        if (tac == cfg->end) break;
+    }
+}
+
+// Variáveis que certamente guardam seu literal na entrada de cada bloco:
+// interseção nos predecessores, MOVE do literal gera e CALL mata todas
+static void optVariablesIn(const CFG* cfg, const ConstDefs* defs, std::vector<Symbol*>* vars,
+                           std::vector<uint64_t>* in, int* wordsOut) {
+    for (TAC* tac = cfg->begin; ; tac = tac->next) {
+        Symbol* def = tacOperands(tac).def;
+        ConstValue value;
+        if (constTracked(def) && def->nature != SYMBOL_TEMP && constGet(&defs->value, def, &value) &&
+            !constGet(&defs->varies, def, &value)) {
+            if ((int)var_bit.size() < symbolCount()) var_bit.resize(symbolCount(), -1);
+            if (var_bit[def->id] < 0) {
+                var_bit[def->id] = (int)vars->size();
+                vars->push_back(def);
+            }
+        }
+        if (tac == cfg->end) break;
+    }
+
+    int blocks = (int)cfg->blocks.size();
+    int words = ((int)vars->size() + 63) / 64;
+    *wordsOut = words;
+    in->assign((size_t)blocks * words, 0);
+    if (words == 0) return;
+
+    std::vector<uint64_t> gen((size_t)blocks * words, 0);
+    std::vector<uint64_t> out((size_t)blocks * words, ~(uint64_t)0);
+    std::vector<char> kills(blocks, 0);
+    for (int b = 0; b < blocks; b++) {
+        uint64_t* g = &gen[(size_t)b * words];
+        for (TAC* tac = cfg->blocks[b].first; ; tac = tac->next) {
+            if (tac->type == TAC_CALL) {
+                kills[b] = 1;
+                for (int w = 0; w < words; w++) g[w] = 0;
+            } else if (tac->type == TAC_MOVE && constTracked((Symbol*)tac->res) &&
+                       ((Symbol*)tac->res)->nature != SYMBOL_TEMP) {
+                int bit = var_bit[((Symbol*)tac->res)->id];
+                if (bit >= 0) g[bit >> 6] |= (uint64_t)1 << (bit & 63);
+            }
+            if (tac == cfg->blocks[b].last) break;
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b : cfg->order) {
+            uint64_t* bin = &(*in)[(size_t)b * words];
+            for (int w = 0; w < words; w++) {
+                uint64_t value = b == cfg->order[0] ? 0 : ~(uint64_t)0;
+                for (int p : cfg->blocks[b].pred) {
+                    if (cfg->blocks[p].rpo >= 0) value &= out[(size_t)p * words + w];
+                }
+                bin[w] = value;
+                uint64_t o = (kills[b] ? 0 : value) | gen[(size_t)b * words + w];
+                if (o != out[(size_t)b * words + w]) {
+                    out[(size_t)b * words + w] = o;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+// Retira as TACs sem efeito colateral que definem temporários nunca lidos.
+// As posições retiradas de region ficam NULL
+static int optRemoveUnusedTemps(std::vector<TAC*>& region) {
+    if ((int)temp_uses.size() < tacTempCount()) temp_uses.resize(tacTempCount(), 0);
+    for (TAC* tac : region) {
+        TacOperands ops = tacOperands(tac);
+        for (int k = 0; k < 3; k++) {
+            if (ops.use[k] && ops.use[k]->nature == SYMBOL_TEMP) temp_uses[ops.use[k]->number]++;
+        }
+    }
+
+    // De trás para frente: uma cadeia de temporários sai numa passada
+    int removed = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = (int)region.size() - 1; i >= 0; i--) {
+            TAC* tac = region[i];
+            if (!tac) continue;
+            bool pure = tac->type == TAC_MOVE || tac->type == TAC_VECTOR_INDEX ||
+                        (tac->type >= TAC_ADD && tac->type <= TAC_NE);
+            Symbol* res = (Symbol*)tac->res;
+            if (!pure || res->nature != SYMBOL_TEMP || temp_uses[res->number] > 0) continue;
+
+            TacOperands ops = tacOperands(tac);
+            for (int k = 0; k < 3; k++) {
+                if (ops.use[k] && ops.use[k]->nature == SYMBOL_TEMP) temp_uses[ops.use[k]->number]--;
+            }
+            tacRemove(tac);
+            region[i] = NULL;
+            removed++;
+            changed = true;
+        }
+    }
+
+    for (TAC* tac : region) {
+        if (!tac) continue;
+        TacOperands ops = tacOperands(tac);
+        for (int k = 0; k < 3; k++) {
+            if (ops.use[k] && ops.use[k]->nature == SYMBOL_TEMP) temp_uses[ops.use[k]->number] = 0;
+        }
+    }
+    return removed;
+}
+
+static void optConstantsFunction(TAC* begin, ConstTable* known, ConstDefs* defs) {
+    ConstStats stats = {0, 0, 0};
+    Symbol* function = (Symbol*)begin->res;
+
+    // Cada rodada pode tornar constantes novos operandos (um MOVE que recebeu
+    // um literal); repete até nada mudar
+    for (;;) {
+        int before = stats.folded + stats.propagated;
+        CFG* cfg = cfgBuild(begin);
+        optCollectDefs(cfg, defs);
+
+        std::vector<Symbol*> vars;
+        std::vector<uint64_t> in;
+        int words;
+        optVariablesIn(cfg, defs, &vars, &in, &words);
+
+        for (const BasicBlock& block : cfg->blocks) {
+            constForgetAll(known);
+            const uint64_t* bin = words ? &in[(size_t)block.id * words] : NULL;
+            for (int w = 0; w < words; w++) {
+                for (uint64_t bits = bin[w]; bits; bits &= bits - 1) {
+                    Symbol* var = vars[w * 64 + __builtin_ctzll(bits)];
+                    ConstValue value;
+                    constGet(&defs->value, var, &value);
+                    constSet(known, var, value);
+                }
+            }
+            for (TAC* tac = block.first; ; tac = tac->next) {
+                optConstantsTac(tac, known, defs, &stats);
+                if (tac == block.last) break;
+            }
+        }
+
+        for (Symbol* var : vars) var_bit[var->id] = -1;
+        TAC* end = cfg->end;
+        cfgFree(cfg);
+        if (stats.folded + stats.propagated == before) {
+            std::vector<TAC*> body;
+            for (TAC* tac = begin; ; tac = tac->next) {
+                body.push_back(tac);
+                if (tac == end) break;
+            }
+            stats.removed = optRemoveUnusedTemps(body);
+            break;
+        }
+    }
+
+    if (opt_stats) {
+        fprintf(stderr, "Constant folding for '%s': %d folded, %d propagated, %d removed\n",
+                function->text.c_str(), stats.folded, stats.propagated, stats.removed);
+    }
+}
+
+// Separa o código global (fora das funções) e o início de cada função
+static void optSplit(TAC* head, std::vector<TAC*>* global, std::vector<TAC*>* functions) {
+    for (TAC* tac = head->next; tac; tac = tac->next) {
+        if (tac->type == TAC_BEGINFUN) {
+            functions->push_back(tac);
+            while (tac->next && tac->type != TAC_ENDFUN) tac = tac->next;
+            continue;
+        }
+        if (global) global->push_back(tac);
+    }
+}
+
+// Dobramento e propagação de constantes no código global e em cada função
+static void optConstants(TAC* head) {
+    ConstTable known;
+    ConstDefs defs;
+    constInit(&known);
+    constInit(&defs.value);
+    constInit(&defs.varies);
+
+    std::vector<TAC*> global;
+    std::vector<TAC*> functions;
+    optSplit(head, &global, &functions);
+
+    ConstStats stats = {0, 0, 0};
+    for (TAC* tac : global) optConstantsTac(tac, &known, NULL, &stats);
+    stats.removed = optRemoveUnusedTemps(global);
+    if (opt_stats) {
+        fprintf(stderr, "Constant folding for global code: %d folded, %d propagated, %d removed\n",
+                stats.folded, stats.propagated, stats.removed);
+    }
+
+    for (TAC* begin : functions) optConstantsFunction(begin, &known, &defs);
+}
+
+// Numeração de valores local (CSE). Dentro de cada bloco, cada operando
+// recebe um número de valor (literais: -1 - id; os demais: números novos a
+// cada definição) e cada operação é identificada por (operação, tipo do
+// resultado, números dos operandos). Uma operação repetida vira MOVE do
+// temporário que já tem o valor, e usos de um temporário passam a ler esse
+// temporário (o MOVE fica para a eliminação de código morto). O vetor também
+// tem um número de valor, renovado a cada VECTOR_ASSIGN ou VECTOR_INIT, então
+// leituras repetidas de v[i] só se juntam se ninguém escreveu em v no meio.
+// CALL renova o número de todas as variáveis e vetores, pois a função chamada
+// pode escrevê-los; MOVE e READ renovam o do destino
+
+// Números de valor por operando: temporários pelo número, variáveis e
+// vetores pelo id, com carimbos como em ConstTable
+typedef struct {
+    std::vector<int> tempVn, varVn;
+    std::vector<int> tempStamp, varStamp;
+    int tempEpoch, varEpoch;
+    int next;                       // próximo número de valor novo
+    std::vector<Symbol*> holder;    // temporário que guarda cada valor
+} VnTable;
+
+typedef struct {
+    int op;
+    int a, b;
+} VnKey;
+
+struct VnKeyHash {
+    size_t operator()(const VnKey& key) const {
+        return ((size_t)key.op * 0x9E3779B1u) ^ ((size_t)(unsigned)key.a * 0x85EBCA77u) ^
+               ((size_t)(unsigned)key.b << 17 | (size_t)(unsigned)key.b >> 15);
+    }
+};
+
+struct VnKeyEqual {
+    bool operator()(const VnKey& x, const VnKey& y) const {
+        return x.op == y.op && x.a == y.a && x.b == y.b;
+    }
+};
+
+typedef std::unordered_map<VnKey, int, VnKeyHash, VnKeyEqual> VnExprs;
+
+typedef struct {
+    int reused;         // operações trocadas por um MOVE
+    int replaced;       // usos trocados pelo temporário que guarda o valor
+} VnStats;
+
+static bool vnTracked(Symbol* s) {
+    if (!s) return false;
+    if (s->nature == SYMBOL_TEMP) return true;
+    return s->type == TK_IDENTIFIER && (s->nature == SYMBOL_SCALAR || s->nature == SYMBOL_VECTOR);
+}
+
+static bool vnIsLiteral(Symbol* s) {
+    return s->type == LIT_INT || s->type == LIT_REAL || s->type == LIT_CHAR || s->type == LIT_STRING;
+}
+
+static int vnFresh(VnTable* table) {
+    return table->next++;
+}
+
+static void vnSet(VnTable* table, Symbol* s, int vn) {
+    bool temp = s->nature == SYMBOL_TEMP;
+    std::vector<int>& stamp = temp ? table->tempStamp : table->varStamp;
+    std::vector<int>& values = temp ? table->tempVn : table->varVn;
+    int key = temp ? s->number : s->id;
+    if (key >= (int)stamp.size()) {
+        int size = temp ? tacTempCount() : symbolCount();
+        stamp.resize(size, 0);
+        values.resize(size);
+    }
+    stamp[key] = temp ? table->tempEpoch : table->varEpoch;
+    values[key] = vn;
+}
+
+// Número de valor corrente do operando (um novo se ainda não tem). 0 para
+// operandos que não são valores (funções, labels)
+static int vnOf(VnTable* table, Symbol* s) {
+    if (!s) return 0;
+    if (vnIsLiteral(s)) return -1 - s->id;
+    if (!vnTracked(s)) return 0;
+    bool temp = s->nature == SYMBOL_TEMP;
+    const std::vector<int>& stamp = temp ? table->tempStamp : table->varStamp;
+    int key = temp ? s->number : s->id;
+    if (key < (int)stamp.size() && stamp[key] == (temp ? table->tempEpoch : table->varEpoch))
+        return temp ? table->tempVn[key] : table->varVn[key];
+    int vn = vnFresh(table);
+    vnSet(table, s, vn);
+    return vn;
+}
+
+// Temporário que ainda guarda o valor vn (NULL se nenhum)
+static Symbol* vnHolder(VnTable* table, int vn) {
+    if (vn <= 0 || vn >= (int)table->holder.size()) return NULL;
+    Symbol* holder = table->holder[vn];
+    return holder && vnOf(table, holder) == vn ? holder : NULL;
+}
+
+static void vnSetHolder(VnTable* table, int vn, Symbol* temp) {
+    if (vn <= 0 || vnHolder(table, vn)) return;
+    if (vn >= (int)table->holder.size()) table->holder.resize(vn + 1024, NULL);
+    table->holder[vn] = temp;
+}
+
+static bool vnCommutative(TacType type) {
+    return type == TAC_ADD || type == TAC_MUL || type == TAC_EQ || type == TAC_NE;
+}
+
+static void optValueNumberTac(TAC* tac, VnTable* table, VnExprs* exprs, VnStats* stats) {
+    // Usos de temporários: lê o temporário que guardou o valor primeiro
+    void** fields[2];
+    int count = tacUseFields(tac, fields);
+    for (int k = 0; k < count; k++) {
+        Symbol* s = (Symbol*)*fields[k];
+        if (!s || s->nature != SYMBOL_TEMP) continue;
+        Symbol* holder = vnHolder(table, vnOf(table, s));
+        if (!holder || holder == s || holder->dataType != s->dataType) continue;
+        *fields[k] = holder;
+        stats->replaced++;
+    }
+
+    Symbol* res = (Symbol*)tac->res;
+    Symbol* op1 = (Symbol*)tac->op1;
+    switch (tac->type) {
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MUL:
+        case TAC_DIV:
+        case TAC_LT:
+        case TAC_GT:
+        case TAC_LE:
+        case TAC_GE:
+        case TAC_EQ:
+        case TAC_NE:
+        case TAC_VECTOR_INDEX: {
+            VnKey key;
+            key.op = (int)tac->type * 8 + (int)res->dataType;
+            key.a = vnOf(table, op1);
+            key.b = vnOf(table, (Symbol*)tac->op2);
+            if (vnCommutative(tac->type) && key.a > key.b) {
+                int a = key.a;
+                key.a = key.b;
+                key.b = a;
+            }
+
+            // Só temporários guardam valores: uma variável trunca o resultado
+            if (res->nature != SYMBOL_TEMP) {
+                vnSet(table, res, vnFresh(table));
+                break;
+            }
+            VnExprs::iterator found = exprs->find(key);
+            Symbol* holder = found == exprs->end() ? NULL : vnHolder(table, found->second);
+            if (holder && holder->dataType == res->dataType) {
+                tac->type = TAC_MOVE;
+                tac->op1 = holder;
+                tac->op2 = NULL;
+                vnSet(table, res, found->second);
+                stats->reused++;
+                break;
+            }
+            int vn = vnFresh(table);
+            vnSet(table, res, vn);
+            vnSetHolder(table, vn, res);
+            (*exprs)[key] = vn;
+            break;
+        }
+        case TAC_MOVE: {
+            // O valor só é o mesmo se não houver conversão nem truncamento:
+            // entre operandos do mesmo tipo, com destino temporário (64 bits)
+            // ou origem e destino variáveis
+            bool same = op1->dataType == res->dataType && !vnIsLiteral(op1) &&
+                        (res->nature == SYMBOL_TEMP || op1->nature != SYMBOL_TEMP);
+            if (res->nature == SYMBOL_TEMP && vnIsLiteral(op1)) {
+                same = (res->dataType == DATATYPE_INT && op1->type == LIT_INT) ||
+                       (res->dataType == DATATYPE_REAL && op1->type == LIT_REAL) ||
+                       (res->dataType == DATATYPE_CHAR && op1->type == LIT_CHAR);
+            }
+            int vn = same ? vnOf(table, op1) : vnFresh(table);
+            vnSet(table, res, vn);
+            if (res->nature == SYMBOL_TEMP) vnSetHolder(table, vn, res);
+            break;
+        }
+        case TAC_VECTOR_ASSIGN:
+        case TAC_VECTOR_INIT:
+        case TAC_READ:
+            vnSet(table, res, vnFresh(table));
+            break;
+        case TAC_CALL:
+            // A função chamada pode escrever qualquer variável ou vetor
+            table->varEpoch++;
+            vnSet(table, res, vnFresh(table));
+            break;
+        default:
+            break;
+    }
+}
+
+static void optValueNumberFunction(TAC* begin, VnTable* table, VnExprs* exprs) {
+    VnStats stats = {0, 0};
+    CFG* cfg = cfgBuild(begin);
+    for (const BasicBlock& block : cfg->blocks) {
+        table->tempEpoch++;
+        table->varEpoch++;
+        if (!exprs->empty()) exprs->clear();
+        for (TAC* tac = block.first; ; tac = tac->next) {
+            optValueNumberTac(tac, table, exprs, &stats);
+            if (tac == block.last) break;
+        }
+    }
+    if (opt_stats) {
+        fprintf(stderr, "Value numbering for '%s': %d expressions reused, %d uses replaced\n",
+                cfg->function->text.c_str(), stats.reused, stats.replaced);
+    }
+    cfgFree(cfg);
+}
+
+static void optValueNumbering(TAC* head) {
+    VnTable table;
+    table.tempEpoch = 1;
+    table.varEpoch = 1;
+    table.next = 1;
+    VnExprs exprs;
+
+    std::vector<TAC*> functions;
+    optSplit(head, NULL, &functions);
+    for (TAC* begin : functions) optValueNumberFunction(begin, &table, &exprs);
+}
+
+// Eliminação de código morto. Cada rodada reconstrói o CFG: IFZ com
+// condição literal vira JUMP (ou some), blocos inalcançáveis saem inteiros,
+// um JUMP para o label seguinte e os labels sem desvio para eles saem, e por
+// fim a análise de vida retira MOVE, operações e VECTOR_INDEX cujo resultado
+// não é lido. CALL, PRINT, READ e VECTOR_ASSIGN sempre ficam
+
+// Labels referenciados por algum desvio da função (por número)
+static std::vector<char> label_used;
+
+static bool optIsPure(TAC* tac) {
+    return tac->type == TAC_MOVE || tac->type == TAC_VECTOR_INDEX || tac->type == TAC_VECTOR_ADDRESS ||
+           tac->type == TAC_POINTER_LOAD || (tac->type >= TAC_ADD && tac->type <= TAC_NE);
+}
+
+// IFZ com condição literal: salta sempre ou nunca. Devolve quantos IFZ
+// mudaram e soma em removed os que saíram
+static int optFoldBranches(TAC* begin, TAC* end, int* removed) {
+    int changed = 0;
+    for (TAC* tac = begin; tac != end; ) {
+        ConstValue value;
+        if (tac->type != TAC_IFZ || !constOfLiteral((Symbol*)tac->op1, &value) || value.real) {
+            tac = tac->next;
+            continue;
+        }
+        changed++;
+        if (value.i == 0) {
+            tac->type = TAC_JUMP;
+            tac->op1 = NULL;
+            tac = tac->next;
+        } else {
+            tac = tacRemove(tac);
+            (*removed)++;
+        }
+    }
+    return changed;
+}
+
+// Blocos inalcançáveis (o ENDFUN fica mesmo que não seja alcançado)
+static int optRemoveUnreachable(const CFG* cfg) {
+    int removed = 0;
+    for (const BasicBlock& block : cfg->blocks) {
+        if (block.rpo >= 0) continue;
+        for (TAC* tac = block.first; ; ) {
+            bool last = tac == block.last;
+            if (tac->type == TAC_ENDFUN) {
+                tac = tac->next;
+            } else {
+                tac = tacRemove(tac);
+                removed++;
+            }
+            if (last) break;
+        }
+    }
+    return removed;
+}
+
+// JUMP para um label logo adiante e labels que nenhum desvio usa
+static int optRemoveJumpsAndLabels(TAC* begin, TAC* end) {
+    if ((int)label_used.size() < tacLabelCount()) label_used.resize(tacLabelCount(), 0);
+    int removed = 0;
+    for (TAC* tac = begin; tac != end; ) {
+        bool next = false;
+        if (tac->type == TAC_JUMP) {
+            for (TAC* after = tac->next; after->type == TAC_LABEL; after = after->next) {
+                if (after->res == tac->res) next = true;
+            }
+        }
+        if (next) {
+            tac = tacRemove(tac);
+            removed++;
+            continue;
+        }
+        if (tac->type == TAC_JUMP || tac->type == TAC_IFZ) label_used[((Symbol*)tac->res)->number] = 1;
+        tac = tac->next;
+    }
+
+    for (TAC* tac = begin; tac != end; ) {
+        if (tac->type == TAC_LABEL && !label_used[((Symbol*)tac->res)->number]) {
+            tac = tacRemove(tac);
+            removed++;
+            continue;
+        }
+        tac = tac->next;
+    }
+    for (TAC* tac = begin; tac != end; tac = tac->next) {
+        if (tac->type == TAC_JUMP || tac->type == TAC_IFZ) label_used[((Symbol*)tac->res)->number] = 0;
+    }
+    return removed;
+}
+
+// Definições sem efeito colateral cujo resultado não está vivo depois delas
+static int optRemoveDeadDefs(const CFG* cfg) {
+    Liveness* live = livenessCompute(cfg);
+    std::vector<uint64_t> set(live->stepWords, 0);
+    std::vector<int> local;     // bits de temporários locais ligados no bloco
+    int removed = 0;
+
+    for (const BasicBlock& block : cfg->blocks) {
+        if (block.rpo < 0) continue;
+        const uint64_t* out = livenessOut(live, block.id);
+        for (int w = 0; w < live->words; w++) set[w] = out[w];
+
+        for (TAC* tac = block.last; ; ) {
+            TAC* prev = tac->prev;
+            bool first = tac == block.first;
+            int def = optIsPure(tac) ? livenessIndex(live, (Symbol*)tac->res) : -1;
+            if (def >= 0 && !livenessTest(&set[0], def)) {
+                tacRemove(tac);
+                removed++;
+            } else {
+                livenessStep(live, tac, &set[0]);
+                TacOperands ops = tacOperands(tac);
+                for (int k = 0; k < 3; k++) {
+                    int use = livenessIndex(live, ops.use[k]);
+                    if (use >= live->blockCount) local.push_back(use);
+                }
+            }
+            if (first) break;
+            tac = prev;
+        }
+
+        // Limpa só o que o bloco ligou, sem varrer o conjunto inteiro
+        for (int index : local) set[index >> 6] &= ~((uint64_t)1 << (index & 63));
+        local.clear();
+    }
+    livenessFree(live);
+    return removed;
+}
+
+// Propagação de constantes condicional esparsa (SCCP, Wegman e Zadeck)
+// sobre a forma SSA. Cada versão começa indefinida e só desce no
+// reticulado (indefinida, constante, variável); um bloco só é avaliado
+// quando alguma aresta que chega nele se torna executável, e um IFZ com
+// condição constante libera só um dos lados. Cada instrução é reavaliada
+// quando um operando desce, no máximo duas vezes por operando. Ao fim, os
+// usos de versões constantes viram literais e os IFZ constantes viram JUMP
+// ou somem; os blocos que ficam inalcançáveis saem na eliminação de código
+// morto
+
+typedef enum {
+    SCCP_TOP,           // ainda sem valor (definição não executada)
+    SCCP_CONST,
+    SCCP_BOTTOM         // valor não constante
+} SccpLevel;
+
+typedef struct {
+    SccpLevel level;
+    ConstValue value;
+} SccpCell;
+
+// Instrução da forma SSA: uma TAC ou um phi de um bloco
+typedef struct {
+    TAC* tac;
+    int block;
+    int phi;            // índice do phi no bloco (-1: TAC)
+} SccpInst;
+
+typedef struct {
+    Ssa* ssa;
+    const CFG* cfg;
+    std::vector<SccpCell> cells;                // por versão
+    std::vector<SccpInst> insts;
+    std::vector<std::vector<int> > users;       // instruções que leem cada versão
+    std::vector<std::vector<char> > edgeExec;   // por bloco, por índice de predecessor
+    std::vector<char> blockExec;
+    std::vector<std::pair<int, int> > flowWork; // arestas que se tornaram executáveis
+    std::vector<int> ssaWork;                   // versões que desceram
+} Sccp;
+
+static SccpCell sccpCellOf(const Sccp* sccp, Symbol* s) {
+    SccpCell cell;
+    cell.level = SCCP_BOTTOM;
+    if (constOfLiteral(s, &cell.value)) {
+        cell.level = SCCP_CONST;
+    } else if (ssaIsVersion(sccp->ssa, s)) {
+        cell = sccp->cells[s->number - sccp->ssa->versionBase];
+    }
+    return cell;
+}
+
+static SccpCell sccpMeet(SccpCell a, SccpCell b) {
+    if (a.level == SCCP_TOP) return b;
+    if (b.level == SCCP_TOP) return a;
+    if (a.level == SCCP_CONST && b.level == SCCP_CONST && constSame(a.value, b.value)) return a;
+    a.level = SCCP_BOTTOM;
+    return a;
+}
+
+// Valor guardado na versão res, convertido como no operando original
+static SccpCell sccpStore(const Sccp* sccp, Symbol* res, SccpCell cell) {
+    if (cell.level == SCCP_CONST && !constStore(ssaOriginal(sccp->ssa, res), cell.value, &cell.value))
+        cell.level = SCCP_BOTTOM;
+    return cell;
+}
+
+static void sccpLower(Sccp* sccp, Symbol* res, SccpCell cell) {
+    if (!ssaIsVersion(sccp->ssa, res)) return;
+    int k = res->number - sccp->ssa->versionBase;
+    SccpCell current = sccp->cells[k];
+    SccpCell next = sccpMeet(current, cell);
+    if (next.level == current.level &&
+        (next.level != SCCP_CONST || constSame(next.value, current.value)))
+        return;
+    sccp->cells[k] = next;
+    sccp->ssaWork.push_back(k);
+}
+
+static void sccpMarkEdge(Sccp* sccp, int from, int to) {
+    if (to < 0) return;
+    const std::vector<int>& pred = sccp->cfg->blocks[to].pred;
+    int j = 0;
+    while (pred[j] != from) j++;
+    if (sccp->edgeExec[to][j]) return;
+    sccp->edgeExec[to][j] = 1;
+    sccp->flowWork.push_back(std::make_pair(from, to));
+}
+
+static void sccpEvalPhi(Sccp* sccp, int b, int i) {
+    const Phi& phi = sccp->ssa->phis[b][i];
+    SccpCell cell;
+    cell.level = SCCP_TOP;
+    for (size_t j = 0; j < phi.args.size(); j++) {
+        if (sccp->edgeExec[b][j]) cell = sccpMeet(cell, sccpCellOf(sccp, phi.args[j]));
+    }
+    sccpLower(sccp, phi.res, cell);
+}
+
+// Avalia uma TAC do bloco b; desvios liberam as arestas que podem seguir
+static void sccpEvalTac(Sccp* sccp, int b, TAC* tac) {
+    const CFG* cfg = sccp->cfg;
+    Symbol* res = (Symbol*)tac->res;
+
+    switch (tac->type) {
+        case TAC_IFZ: {
+            SccpCell cond = sccpCellOf(sccp, (Symbol*)tac->op1);
+            int target = cfgBlockOf(cfg, res);
+            int next = b + 1 < (int)cfg->blocks.size() ? b + 1 : -1;
+            if (cond.level == SCCP_TOP) return;
+            if (cond.level == SCCP_CONST && !cond.value.real) {
+                sccpMarkEdge(sccp, b, cond.value.i == 0 ? target : next);
+            } else {
+                sccpMarkEdge(sccp, b, target);
+                sccpMarkEdge(sccp, b, next);
+            }
+            return;
+        }
+        case TAC_JUMP:
+            sccpMarkEdge(sccp, b, cfgBlockOf(cfg, res));
+            return;
+        case TAC_MOVE:
+            sccpLower(sccp, res, sccpStore(sccp, res, sccpCellOf(sccp, (Symbol*)tac->op1)));
+            break;
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MUL:
+        case TAC_DIV:
+        case TAC_LT:
+        case TAC_GT:
+        case TAC_LE:
+        case TAC_GE:
+        case TAC_EQ:
+        case TAC_NE: {
+            SccpCell a = sccpCellOf(sccp, (Symbol*)tac->op1);
+            SccpCell c = sccpCellOf(sccp, (Symbol*)tac->op2);
+            SccpCell cell;
+            if (a.level == SCCP_BOTTOM || c.level == SCCP_BOTTOM) {
+                cell.level = SCCP_BOTTOM;
+            } else if (a.level == SCCP_TOP || c.level == SCCP_TOP) {
+                cell.level = SCCP_TOP;
+            } else {
+                bool realDiv = ssaOriginal(sccp->ssa, res)->dataType == DATATYPE_REAL;
+                cell.level = constFold(tac->type, a.value, c.value, realDiv, &cell.value) ? SCCP_CONST : SCCP_BOTTOM;
+            }
+            sccpLower(sccp, res, sccpStore(sccp, res, cell));
+            break;
+        }
+        default: {
+            // VECTOR_INDEX, READ e CALL produzem valores desconhecidos
+            Symbol* def = tacOperands(tac).def;
+            SccpCell cell;
+            cell.level = SCCP_BOTTOM;
+            if (def) sccpLower(sccp, def, cell);
+            break;
+        }
+    }
+
+    // Fim de bloco sem desvio: segue para o próximo
+    if (tac == cfg->blocks[b].last && tac->type != TAC_RET && tac->type != TAC_ENDFUN) {
+        for (int s : cfg->blocks[b].succ) sccpMarkEdge(sccp, b, s);
+    }
+}
+
+static void sccpEval(Sccp* sccp, const SccpInst& inst) {
+    if (inst.phi >= 0) sccpEvalPhi(sccp, inst.block, inst.phi);
+    else sccpEvalTac(sccp, inst.block, inst.tac);
+}
+
+// Instruções e usuários de cada versão
+static void sccpCollect(Sccp* sccp) {
+    const CFG* cfg = sccp->cfg;
+    Ssa* ssa = sccp->ssa;
+    sccp->users.assign(ssa->original.size(), std::vector<int>());
+    for (int b : cfg->order) {
+        for (size_t i = 0; i < ssa->phis[b].size(); i++) {
+            SccpInst inst = {NULL, b, (int)i};
+            int id = (int)sccp->insts.size();
+            sccp->insts.push_back(inst);
+            for (Symbol* arg : ssa->phis[b][i].args) {
+                if (ssaIsVersion(ssa, arg)) sccp->users[arg->number - ssa->versionBase].push_back(id);
+            }
+        }
+        for (TAC* tac = cfg->blocks[b].first; ; tac = tac->next) {
+            SccpInst inst = {tac, b, -1};
+            int id = (int)sccp->insts.size();
+            sccp->insts.push_back(inst);
+            void** fields[2];
+            int count = tacUseFields(tac, fields);
+            for (int k = 0; k < count; k++) {
+                Symbol* s = (Symbol*)*fields[k];
+                if (ssaIsVersion(ssa, s)) sccp->users[s->number - ssa->versionBase].push_back(id);
+            }
+            if (tac == cfg->blocks[b].last) break;
+        }
+    }
+}
+
+static void optSccpFunction(TAC* begin) {
+    CFG* cfg = cfgBuild(begin);
+    Ssa* ssa = ssaBuild(cfg);
+    int constants = 0, branches = 0, removed = 0;
+
+    Sccp sccp;
+    sccp.ssa = ssa;
+    sccp.cfg = cfg;
+    SccpCell top;
+    top.level = SCCP_TOP;
+    top.value.real = false;
+    top.value.i = 0;
+    top.value.r = 0;
+    sccp.cells.assign(ssa->original.size(), top);
+    sccp.blockExec.assign(cfg->blocks.size(), 0);
+    sccp.edgeExec.resize(cfg->blocks.size());
+    for (const BasicBlock& block : cfg->blocks) {
+        sccp.edgeExec[block.id].assign(block.pred.size(), 0);
+    }
+    sccpCollect(&sccp);
+
+    // Primeira instrução de cada bloco em insts (phis e TACs são contíguos)
+    std::vector<int> firstInst(cfg->blocks.size(), -1);
+    for (int i = (int)sccp.insts.size() - 1; i >= 0; i--) firstInst[sccp.insts[i].block] = i;
+
+    std::vector<int> visit;
+    if (!cfg->order.empty()) visit.push_back(cfg->order[0]);
+    while (!visit.empty() || !sccp.flowWork.empty() || !sccp.ssaWork.empty()) {
+        if (!visit.empty()) {
+            // Primeira visita: todos os phis e TACs do bloco
+            int b = visit.back();
+            visit.pop_back();
+            sccp.blockExec[b] = 1;
+            for (int i = firstInst[b]; i < (int)sccp.insts.size() && sccp.insts[i].block == b; i++) {
+                sccpEval(&sccp, sccp.insts[i]);
+            }
+        } else if (!sccp.flowWork.empty()) {
+            int b = sccp.flowWork.back().second;
+            sccp.flowWork.pop_back();
+            if (!sccp.blockExec[b]) {
+                sccp.blockExec[b] = 1;
+                visit.push_back(b);
+            } else {
+                for (size_t i = 0; i < ssa->phis[b].size(); i++) sccpEvalPhi(&sccp, b, (int)i);
+            }
+        } else {
+            int k = sccp.ssaWork.back();
+            sccp.ssaWork.pop_back();
+            for (int id : sccp.users[k]) {
+                if (sccp.blockExec[sccp.insts[id].block]) sccpEval(&sccp, sccp.insts[id]);
+            }
+        }
+    }
+
+    // Usos de versões constantes viram literais nos blocos executáveis
+    for (int b : cfg->order) {
+        if (!sccp.blockExec[b]) continue;
+        for (TAC* tac = cfg->blocks[b].first; ; tac = tac->next) {
+            void** fields[2];
+            int count = tacUseFields(tac, fields);
+            for (int k = 0; k < count; k++) {
+                Symbol* s = (Symbol*)*fields[k];
+                if (!ssaIsVersion(ssa, s)) continue;
+                SccpCell cell = sccpCellOf(&sccp, s);
+                if (cell.level != SCCP_CONST) continue;
+                Symbol* literal = constLiteral(cell.value, ssaOriginal(ssa, s)->dataType);
+                if (!literal) continue;
+                *fields[k] = literal;
+                constants++;
+            }
+            if (tac == cfg->blocks[b].last) break;
+        }
+    }
+
+    int phis = ssa->phiCount;
+    ssaDestroy(ssa);
+    branches = optFoldBranches(cfg->begin, cfg->end, &removed);
+    if (opt_stats) {
+        fprintf(stderr, "SCCP for '%s': %d phis, %d constants, %d branches folded\n",
+                cfg->function->text.c_str(), phis, constants, branches);
+    }
+    cfgFree(cfg);
+}
+
+static void optSccp(TAC* head) {
+    std::vector<TAC*> functions;
+    optSplit(head, NULL, &functions);
+    for (TAC* begin : functions) optSccpFunction(begin);
+}
+
+static void optDeadCodeFunction(TAC* begin) {
+    Symbol* function = (Symbol*)begin->res;
+    int removed = 0;
+
+    for (;;) {
+        TAC* end = begin;
+        while (end->type != TAC_ENDFUN && end->next) end = end->next;
+
+        int before = removed;
+        int changed = optFoldBranches(begin, end, &removed);
+        CFG* cfg = cfgBuild(begin);
+        int cut = optRemoveUnreachable(cfg);
+        cut += optRemoveJumpsAndLabels(begin, end);
+        removed += cut;
+
+        // Se os blocos mudaram, a análise de vida precisa de um CFG novo
+        if (changed + cut > 0) {
+            cfgFree(cfg);
+            cfg = cfgBuild(begin);
+        }
+        removed += optRemoveDeadDefs(cfg);
+        cfgFree(cfg);
+        if (removed == before) break;
+    }
+
+    if (opt_stats) {
+        fprintf(stderr, "Dead code elimination for '%s': %d TACs removed\n", function->text.c_str(), removed);
+    }
+}
+
+static void optDeadCode(TAC* head) {
+    std::vector<TAC*> functions;
+    optSplit(head, NULL, &functions);
+    for (TAC* begin : functions) optDeadCodeFunction(begin);
+}
+
+// Análise de intervalos para retirar a verificação de limites dos acessos a
+// vetor. Sobre a forma SSA, cada versão inteira recebe um intervalo [lo, hi]
+// calculado a partir da TAC que a define (ou do phi), com literais exatos,
+// variáveis não versionadas (valor na entrada ou depois de CALL) no
+// intervalo do tipo e truncamento ao tamanho da variável quando o valor é
+// guardado nela. Um uso é refinado pelas condições dos desvios que o
+// dominam: cada bloco com um único predecessor terminado em IFZ de uma
+// comparação entre inteiros limita os operandos dela (a < b no caminho de
+// fallthrough, a >= b no do label) em todos os blocos que domina. Os
+// blocos são reavaliados em ordem reversa, só os que leem uma versão que
+// mudou, até o ponto fixo, com alargamento nos phis dos limites que continuam
+// crescendo depois de algumas mudanças; uma segunda rodada de
+// estreitamento recupera os limites finitos (o contador de um while
+// i < 10 fica em [0, 10]). Um VECTOR_INDEX ou VECTOR_ASSIGN cujo índice
+// cabe em 0..vectorSize-1 é marcado inBounds e o backend não o verifica
+
+static const long RANGE_INF = LONG_MAX / 4;     // limite infinito (saturação)
+static const int RANGE_WIDEN = 3;               // mudanças antes de alargar
+
+typedef struct {
+    long lo, hi;                    // vazio (não alcançado) se lo > hi
+} Range;
+
+// Condição "versão <op> other" que vale nos blocos dominados por block
+typedef struct {
+    int block;
+    TacType op;
+    Symbol* other;
+} RangeGuard;
+
+typedef struct {
+    const CFG* cfg;
+    const Ssa* ssa;
+    std::vector<Range> range;       // por versão (número - versionBase)
+    std::vector<TAC*> def;          // TAC que define cada versão (NULL: phi)
+    std::vector<int> changes;       // vezes que cada intervalo mudou
+    std::vector<std::vector<RangeGuard>> guards; // condições sobre cada versão
+    std::vector<std::vector<int>> users; // blocos (posição na ordem) que leem cada versão
+    std::vector<char> pending;      // blocos na fila, por posição na ordem
+    std::priority_queue<int, std::vector<int>, std::greater<int>> queue; // posições a reavaliar
+    std::vector<long> thresholds;   // literais comparados na função, em ordem
+    bool narrowing;
+} Ranges;
+
+static Range rangeMake(long lo, long hi) {
+    Range r = {std::max(lo, -RANGE_INF), std::min(hi, RANGE_INF)};
+    return r;
+}
+
+static Range rangeTop(void) {
+    return rangeMake(-RANGE_INF, RANGE_INF);
+}
+
+static Range rangeEmpty(void) {
+    Range r = {1, 0};
+    return r;
+}
+
+static bool rangeIsEmpty(Range r) {
+    return r.lo > r.hi;
+}
+
+// Valores que uma variável (ou elemento de vetor) do tipo guarda. Reais e
+// strings não são acompanhados (intervalo total)
+static Range rangeOfType(DataType type) {
+    if (type == DATATYPE_CHAR) return rangeMake(0, 255);
+    if (type == DATATYPE_INT) return rangeMake(INT_MIN, INT_MAX);
+    return rangeTop();
+}
+
+static bool rangeTracked(Symbol* s) {
+    if (!s) return false;
+    if (s->type == LIT_INT || s->type == LIT_CHAR) return true;
+    if (s->type == LIT_REAL || s->type == LIT_STRING) return false;
+    return s->dataType == DATATYPE_INT || s->dataType == DATATYPE_CHAR;
+}
+
+static Range rangeJoin(Range a, Range b) {
+    if (rangeIsEmpty(a)) return b;
+    if (rangeIsEmpty(b)) return a;
+    return rangeMake(std::min(a.lo, b.lo), std::max(a.hi, b.hi));
+}
+
+static Range rangeOf(const Ranges* ranges, Symbol* s) {
+    ConstValue value;
+    if (!rangeTracked(s)) return rangeTop();
+    if (constOfLiteral(s, &value)) return rangeMake(value.i, value.i);
+    if (ssaIsVersion(ranges->ssa, s)) return ranges->range[s->number - ranges->ssa->versionBase];
+    if (s->nature == SYMBOL_TEMP) return rangeTop();
+    return rangeOfType(s->dataType);
+}
+
+// Limita r (intervalo de x) pela condição "x <op> other" com other em o
+static Range rangeConstrain(Range r, TacType op, Range o) {
+    if (rangeIsEmpty(o)) return r;
+    switch (op) {
+        case TAC_LT: r.hi = std::min(r.hi, o.hi - 1); break;
+        case TAC_LE: r.hi = std::min(r.hi, o.hi); break;
+        case TAC_GT: r.lo = std::max(r.lo, o.lo + 1); break;
+        case TAC_GE: r.lo = std::max(r.lo, o.lo); break;
+        case TAC_EQ:
+            r.lo = std::max(r.lo, o.lo);
+            r.hi = std::min(r.hi, o.hi);
+            break;
+        default:
+            if (o.lo == o.hi && r.lo == o.lo) r.lo++;
+            else if (o.lo == o.hi && r.hi == o.hi) r.hi--;
+            break;
+    }
+    return r;
+}
+
+// Comparação invertida (a <op> b como b <op'> a) e negada (para inteiros)
+static TacType rangeSwap(TacType op) {
+    switch (op) {
+        case TAC_LT: return TAC_GT;
+        case TAC_GT: return TAC_LT;
+        case TAC_LE: return TAC_GE;
+        case TAC_GE: return TAC_LE;
+        default: return op;
+    }
+}
+
+static TacType rangeNegate(TacType op) {
+    switch (op) {
+        case TAC_LT: return TAC_GE;
+        case TAC_GE: return TAC_LT;
+        case TAC_GT: return TAC_LE;
+        case TAC_LE: return TAC_GT;
+        case TAC_EQ: return TAC_NE;
+        default: return TAC_EQ;
+    }
+}
+
+// Bloco com um único predecessor terminado em IFZ: a condição vale nele
+static bool rangeConditioned(const CFG* cfg, int b) {
+    const BasicBlock& block = cfg->blocks[b];
+    return block.pred.size() == 1 && cfg->blocks[block.pred[0]].last->type == TAC_IFZ;
+}
+
+// Registra as condições que o desvio do único predecessor de b garante
+// sobre os operandos da comparação testada
+static void rangeAddGuards(Ranges* ranges, int b) {
+    const CFG* cfg = ranges->cfg;
+    int from = cfg->blocks[b].pred[0];
+    TAC* branch = cfg->blocks[from].last;
+    Symbol* cond = (Symbol*)branch->op1;
+    if (!ssaIsVersion(ranges->ssa, cond)) return;
+    TAC* test = ranges->def[cond->number - ranges->ssa->versionBase];
+    if (!test || test->type < TAC_LT || test->type > TAC_NE) return;
+    Symbol* a = (Symbol*)test->op1;
+    Symbol* c = (Symbol*)test->op2;
+    if (!rangeTracked(a) || !rangeTracked(c)) return;
+    int target = cfgBlockOf(cfg, (Symbol*)branch->res);
+    if (target == from + 1) return;
+    TacType op = b == target ? rangeNegate(test->type) : test->type;
+    if (ssaIsVersion(ranges->ssa, a)) ranges->guards[a->number - ranges->ssa->versionBase].push_back({b, op, c});
+    if (ssaIsVersion(ranges->ssa, c)) ranges->guards[c->number - ranges->ssa->versionBase].push_back({b, rangeSwap(op), a});
+}
+
+// Intervalo de s num uso no bloco b, refinado pelos desvios que dominam b
+static Range rangeAt(const Ranges* ranges, Symbol* s, int b) {
+    Range r = rangeOf(ranges, s);
+    if (!ssaIsVersion(ranges->ssa, s)) return r;
+    for (const RangeGuard& guard : ranges->guards[s->number - ranges->ssa->versionBase])
+        if (cfgDominates(ranges->cfg, guard.block, b)) r = rangeConstrain(r, guard.op, rangeOf(ranges, guard.other));
+    return r;
+}
+
+// Valores que a versão s pode ter: o tipo, se é de uma variável (um valor
+// que passa do tipo dá a volta ao ser guardado), ou tudo, se é temporário
+// (temporários guardam os 64 bits da conta)
+static Range rangeLimit(const Ranges* ranges, Symbol* s) {
+    Symbol* original = ssaOriginal(ranges->ssa, s);
+    return original->nature == SYMBOL_TEMP ? rangeTop() : rangeOfType(original->dataType);
+}
+
+// Valor guardado em res: truncado ao limite da versão
+static Range rangeStore(const Ranges* ranges, Symbol* res, Range r) {
+    if (!rangeTracked(res)) return rangeTop();
+    Range limit = rangeLimit(ranges, res);
+    return rangeIsEmpty(r) || (r.lo >= limit.lo && r.hi <= limit.hi) ? r : limit;
+}
+
+static Range rangeArith(TacType op, Range a, Range c) {
+    if (rangeIsEmpty(a) || rangeIsEmpty(c)) return rangeEmpty();
+    long bound = 1L << 30;
+    switch (op) {
+        case TAC_ADD:
+            return rangeMake(a.lo <= -RANGE_INF || c.lo <= -RANGE_INF ? -RANGE_INF : a.lo + c.lo,
+                             a.hi >= RANGE_INF || c.hi >= RANGE_INF ? RANGE_INF : a.hi + c.hi);
+        case TAC_SUB:
+            return rangeMake(a.lo <= -RANGE_INF || c.hi >= RANGE_INF ? -RANGE_INF : a.lo - c.hi,
+                             a.hi >= RANGE_INF || c.lo <= -RANGE_INF ? RANGE_INF : a.hi - c.lo);
+        case TAC_MUL: {
+            if (std::max(-a.lo, a.hi) > bound || std::max(-c.lo, c.hi) > bound) return rangeTop();
+            long p[4] = {a.lo * c.lo, a.lo * c.hi, a.hi * c.lo, a.hi * c.hi};
+            return rangeMake(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+        }
+        default:
+            return rangeMake(0, 1);     // comparações
+    }
+}
+
+// Intervalo do valor que a TAC define, com os usos refinados no bloco b
+static Range rangeEvalTac(const Ranges* ranges, TAC* tac, int b) {
+    Symbol* res = (Symbol*)tac->res;
+    Symbol* op1 = (Symbol*)tac->op1;
+    Symbol* op2 = (Symbol*)tac->op2;
+    switch (tac->type) {
+        case TAC_MOVE:
+            return rangeTracked(op1) ? rangeStore(ranges, res, rangeAt(ranges, op1, b)) : rangeTop();
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MUL:
+        case TAC_LT:
+        case TAC_GT:
+        case TAC_LE:
+        case TAC_GE:
+        case TAC_EQ:
+        case TAC_NE:
+            if (tac->type <= TAC_MUL && (!rangeTracked(op1) || !rangeTracked(op2))) return rangeTop();
+            return rangeStore(ranges, res, rangeArith(tac->type, rangeAt(ranges, op1, b), rangeAt(ranges, op2, b)));
+        case TAC_VECTOR_INDEX:
+            return rangeStore(ranges, res, rangeOfType(op1->dataType));
+        case TAC_CALL:
+            return rangeStore(ranges, res, rangeOfType(op1->returnType));
+        case TAC_READ:
+            return rangeOfType(res->dataType);
+        default:
+            return rangeTop();
+    }
+}
+
+static void rangeQueue(Ranges* ranges, int at) {
+    if (ranges->pending[at]) return;
+    ranges->pending[at] = 1;
+    ranges->queue.push(at);
+}
+
+// Limite alargado de um phi que continua crescendo: o próximo literal
+// comparado na função, depois o limite do tipo e por fim o infinito. Um
+// limite infinito numa variável faria as contas sobre ela passarem do
+// tipo, e o truncamento perderia também o outro limite
+static long rangeWidenHi(const Ranges* ranges, long hi, long limit) {
+    auto next = std::lower_bound(ranges->thresholds.begin(), ranges->thresholds.end(), hi);
+    if (next != ranges->thresholds.end() && *next < limit) return *next;
+    return hi <= limit ? limit : RANGE_INF;
+}
+
+static long rangeWidenLo(const Ranges* ranges, long lo, long limit) {
+    auto next = std::upper_bound(ranges->thresholds.begin(), ranges->thresholds.end(), lo);
+    if (next != ranges->thresholds.begin() && *(next - 1) > limit) return *(next - 1);
+    return lo >= limit ? limit : -RANGE_INF;
+}
+
+// Junta r ao intervalo de s. Só os phis alargam: todo ciclo entre versões
+// passa por um phi
+static void rangeUpdate(Ranges* ranges, Symbol* s, Range r, bool phi) {
+    if (!ssaIsVersion(ranges->ssa, s)) return;
+    int k = s->number - ranges->ssa->versionBase;
+    Range old = ranges->range[k];
+    Range limit = rangeLimit(ranges, s);
+    if (ranges->narrowing) {
+        // Estreitamento: só limites alargados trocam pelo valor calculado
+        if (rangeIsEmpty(old) || rangeIsEmpty(r)) return;
+        if (old.lo <= -RANGE_INF || old.lo == limit.lo) old.lo = std::max(old.lo, r.lo);
+        if (old.hi >= RANGE_INF || old.hi == limit.hi) old.hi = std::min(old.hi, r.hi);
+    } else {
+        Range joined = rangeJoin(old, r);
+        if (phi && !rangeIsEmpty(old) && ranges->changes[k] >= RANGE_WIDEN) {
+            if (joined.lo < old.lo) joined.lo = rangeWidenLo(ranges, joined.lo, limit.lo);
+            if (joined.hi > old.hi) joined.hi = rangeWidenHi(ranges, joined.hi, limit.hi);
+        }
+        old = joined;
+    }
+    Range& cell = ranges->range[k];
+    if (old.lo == cell.lo && old.hi == cell.hi) return;
+    cell = old;
+    ranges->changes[k]++;
+    for (int user : ranges->users[k]) rangeQueue(ranges, user);
+}
+
+// Reavalia os phis e as definições do bloco b
+static void rangeBlock(Ranges* ranges, int b) {
+    const CFG* cfg = ranges->cfg;
+    const BasicBlock& block = cfg->blocks[b];
+    for (const Phi& phi : ranges->ssa->phis[b]) {
+        Range r = rangeEmpty();
+        for (size_t j = 0; j < phi.args.size(); j++) {
+            if (!phi.args[j] || cfg->blocks[block.pred[j]].rpo < 0) continue;
+            r = rangeJoin(r, rangeTracked(phi.args[j]) ? rangeAt(ranges, phi.args[j], block.pred[j]) : rangeTop());
+        }
+        rangeUpdate(ranges, phi.res, r, true);
+    }
+    for (TAC* tac = block.first; ; tac = tac->next) {
+        Symbol* def = tacOperands(tac).def;
+        if (def && ssaIsVersion(ranges->ssa, def)) rangeUpdate(ranges, def, rangeEvalTac(ranges, tac, b), false);
+        if (tac == block.last) break;
+    }
+}
+
+// Leitores de cada versão: blocos em que ela é operando ou argumento de
+// phi e, através das condições, blocos que leem a versão que ela limita
+static void rangeFindUsers(Ranges* ranges) {
+    const CFG* cfg = ranges->cfg;
+    const Ssa* ssa = ranges->ssa;
+    std::vector<std::vector<int>> direct(ssa->original.size());
+    for (int b : cfg->order) {
+        int at = cfg->blocks[b].rpo;
+        for (const Phi& phi : ssa->phis[b])
+            for (Symbol* arg : phi.args)
+                if (arg && ssaIsVersion(ssa, arg)) direct[arg->number - ssa->versionBase].push_back(at);
+        for (TAC* tac = cfg->blocks[b].first; ; tac = tac->next) {
+            TacOperands operands = tacOperands(tac);
+            for (Symbol* use : operands.use)
+                if (use && ssaIsVersion(ssa, use)) direct[use->number - ssa->versionBase].push_back(at);
+            if (tac == cfg->blocks[b].last) break;
+        }
+    }
+    ranges->users = direct;
+    for (size_t k = 0; k < direct.size(); k++) {
+        for (const RangeGuard& guard : ranges->guards[k]) {
+            if (!ssaIsVersion(ssa, guard.other)) continue;
+            std::vector<int>& users = ranges->users[guard.other->number - ssa->versionBase];
+            users.insert(users.end(), direct[k].begin(), direct[k].end());
+        }
+    }
+}
+
+// Versão com um limite que o estreitamento pode refazer (infinito ou no
+// limite do tipo)
+static bool rangeWidened(const Ranges* ranges, Symbol* s) {
+    if (!rangeTracked(s)) return false;
+    Range r = ranges->range[s->number - ranges->ssa->versionBase];
+    Range limit = rangeLimit(ranges, s);
+    return r.lo <= -RANGE_INF || r.hi >= RANGE_INF || r.lo == limit.lo || r.hi == limit.hi;
+}
+
+// Bloco que define versão inteira com limite alargado (a estreitar)
+static bool rangeUnbounded(const Ranges* ranges, int b) {
+    const Ssa* ssa = ranges->ssa;
+    for (const Phi& phi : ssa->phis[b]) {
+        if (rangeWidened(ranges, phi.res)) return true;
+    }
+    for (TAC* tac = ranges->cfg->blocks[b].first; ; tac = tac->next) {
+        Symbol* def = tacOperands(tac).def;
+        if (def && ssaIsVersion(ssa, def) && rangeWidened(ranges, def)) return true;
+        if (tac == ranges->cfg->blocks[b].last) break;
+    }
+    return false;
+}
+
+// Reavalia os blocos até nenhum mudar, sempre o pendente mais cedo na
+// ordem reversa: um laço estabiliza antes do código que vem depois dele.
+// No estreitamento só mudam os blocos com limites infinitos
+static void rangeSolve(Ranges* ranges) {
+    const CFG* cfg = ranges->cfg;
+    ranges->pending.assign(cfg->order.size(), 0);
+    for (size_t i = 0; i < cfg->order.size(); i++)
+        if (!ranges->narrowing || rangeUnbounded(ranges, cfg->order[i])) rangeQueue(ranges, i);
+    while (!ranges->queue.empty()) {
+        int at = ranges->queue.top();
+        ranges->queue.pop();
+        ranges->pending[at] = 0;
+        rangeBlock(ranges, cfg->order[at]);
+    }
+}
+
+static void optRangesFunction(TAC* begin) {
+    // Sem acessos a vetor não há o que provar
+    int accesses = 0, proved = 0;
+    for (TAC* tac = begin; tac && tac->type != TAC_ENDFUN; tac = tac->next)
+        if (tac->type == TAC_VECTOR_INDEX || tac->type == TAC_VECTOR_ASSIGN) accesses++;
+    if (accesses == 0) {
+        if (opt_stats) {
+            fprintf(stderr, "Range analysis for '%s': 0 of 0 vector accesses proved in bounds\n",
+                    ((Symbol*)begin->res)->text.c_str());
+        }
+        return;
+    }
+
+    CFG* cfg = cfgBuild(begin);
+    Ssa* ssa = ssaBuild(cfg);
+
+    Ranges ranges;
+    ranges.cfg = cfg;
+    ranges.ssa = ssa;
+    ranges.range.assign(ssa->original.size(), rangeEmpty());
+    ranges.def.assign(ssa->original.size(), (TAC*)NULL);
+    ranges.changes.assign(ssa->original.size(), 0);
+    ranges.guards.resize(ssa->original.size());
+    for (int b : cfg->order) {
+        for (TAC* tac = cfg->blocks[b].first; ; tac = tac->next) {
+            Symbol* def = tacOperands(tac).def;
+            if (def && ssaIsVersion(ssa, def)) ranges.def[def->number - ssa->versionBase] = tac;
+            if (tac == cfg->blocks[b].last) break;
+        }
+    }
+    for (int b : cfg->order)
+        if (rangeConditioned(cfg, b)) rangeAddGuards(&ranges, b);
+    for (TAC* tac = begin; tac != cfg->end; tac = tac->next) {
+        ConstValue value;
+        if (tac->type < TAC_LT || tac->type > TAC_NE) continue;
+        if (constOfLiteral((Symbol*)tac->op1, &value) && !value.real) ranges.thresholds.push_back(value.i);
+        if (constOfLiteral((Symbol*)tac->op2, &value) && !value.real) ranges.thresholds.push_back(value.i);
+    }
+    std::sort(ranges.thresholds.begin(), ranges.thresholds.end());
+    ranges.thresholds.erase(std::unique(ranges.thresholds.begin(), ranges.thresholds.end()), ranges.thresholds.end());
+
+    rangeFindUsers(&ranges);
+
+    ranges.narrowing = false;
+    rangeSolve(&ranges);
+    ranges.narrowing = true;
+    rangeSolve(&ranges);
+
+    accesses = 0;
+    for (int b : cfg->order) {
+        for (TAC* tac = cfg->blocks[b].first; ; tac = tac->next) {
+            Symbol* vector = (Symbol*)(tac->type == TAC_VECTOR_INDEX ? tac->op1 : tac->res);
+            Symbol* index = tac->type == TAC_VECTOR_INDEX ? (Symbol*)tac->op2 :
+                            tac->type == TAC_VECTOR_ASSIGN ? (Symbol*)tac->op1 : NULL;
+            if (index) {
+                accesses++;
+                Range r = rangeTracked(index) ? rangeAt(&ranges, index, b) : rangeTop();
+                if (!rangeIsEmpty(r) && r.lo >= 0 && r.hi < vector->vectorSize) {
+                    tac->inBounds = true;
+                    proved++;
+                }
+            }
+            if (tac == cfg->blocks[b].last) break;
+        }
+    }
+
+    if (opt_stats) {
+        fprintf(stderr, "Range analysis for '%s': %d of %d vector accesses proved in bounds\n",
+                cfg->function->text.c_str(), proved, accesses);
+    }
+    ssaDestroy(ssa);
+    cfgFree(cfg);
+}
+
+static void optRanges(TAC* head) {
+    std::vector<TAC*> functions;
+    optSplit(head, NULL, &functions);
+    for (TAC* begin : functions) optRangesFunction(begin);
+}
+
+// Movimentação de código invariante de laços (LICM). Um laço natural
+// gerado por while ou do-while tem um único predecessor fora dele, o bloco
+// que cai no label do cabeçalho; as TACs invariantes vão para logo antes
+// desse label (o pré-cabeçalho), na ordem em que foram achadas. Uma TAC é
+// invariante quando define um temporário escrito uma vez só no laço e seus
+// operandos são literais, temporários já movidos ou operandos que o laço
+// não escreve. VECTOR_ASSIGN e VECTOR_INIT escrevem o vetor, READ a variável,
+// e uma CALL escreve todas as variáveis e vetores. O temporário não pode estar vivo na
+// entrada do cabeçalho nem nas saídas do laço, e VECTOR_INDEX só é
+// antecipado se o índice for um literal dentro do vetor ou se o bloco
+// executar sempre que o laço começa. Num while, o teste do cabeçalho pode
+// ser repetido antes do label como guarda, e aí bastam os blocos que
+// executam em toda volta completa. Os laços mais internos vêm primeiro, e o
+// CFG é refeito a cada nível que mudou
+
+typedef struct {
+    int hoisted;
+    int loops;
+    int guarded;        // laços que ganharam a guarda do while
+} LicmStats;
+
+// Operandos escritos no laço corrente (stamp = laço) e quantas vezes
+typedef struct {
+    std::vector<int> stamp;
+    std::vector<int> writes;
+    std::vector<int> hoisted;   // temporários movidos (stamp = laço)
+    std::vector<int> inLoop;    // blocos do laço (stamp = laço)
+    int current;
+    bool call;                  // o laço tem CALL
+} LicmWrites;
+
+// Liga uma TAC solta antes de where
+static void optInsertBefore(TAC* tac, TAC* where) {
+    tac->prev = where->prev;
+    tac->next = where;
+    where->prev->next = tac;
+    where->prev = tac;
+}
+
+// Tira a TAC da lista e a coloca antes de where
+static void optMoveBefore(TAC* tac, TAC* where) {
+    tac->prev->next = tac->next;
+    if (tac->next) tac->next->prev = tac->prev;
+    optInsertBefore(tac, where);
+}
+
+// Pré-cabeçalho do laço: o único predecessor de fora, que cai no label do
+// cabeçalho (-1 se não houver). Os blocos do laço têm inLoop igual a stamp
+static int optPreheader(const CFG* cfg, const Loop& loop, const std::vector<int>& inLoop, int stamp) {
+    const BasicBlock& header = cfg->blocks[loop.header];
+    int preheader = -1;
+    for (int p : header.pred) {
+        if (inLoop[p] == stamp) continue;
+        if (preheader >= 0) return -1;
+        preheader = p;
+    }
+    if (preheader < 0 || preheader != loop.header - 1) return -1;
+    TAC* fall = cfg->blocks[preheader].last;
+    if (fall->type == TAC_JUMP || (fall->type == TAC_IFZ && fall->res == header.first->res)) return -1;
+    if (header.first->type != TAC_LABEL) return -1;
+    return preheader;
+}
+
+static bool licmInvariant(const Liveness* live, const LicmWrites* writes, Symbol* s) {
+    int index = livenessIndex(live, s);
+    if (index < 0) return true;
+    if (s->nature == SYMBOL_TEMP && writes->hoisted[index] == writes->current) return true;
+    if (writes->stamp[index] == writes->current) return false;
+    return s->nature == SYMBOL_TEMP || !writes->call;
+}
+
+// Leitura de vetor que pode ser feita mesmo se o laço não a executaria
+static bool licmSafeIndex(TAC* tac) {
+    Symbol* vector = (Symbol*)tac->op1;
+    ConstValue index;
+    return constOfLiteral((Symbol*)tac->op2, &index) && !index.real &&
+           index.i >= 0 && index.i < vector->vectorSize;
+}
+
+static bool licmHoistable(const Liveness* live, const LicmWrites* writes, TAC* tac,
+                          const std::vector<int>& exits, bool coversExits) {
+    if (!(tac->type >= TAC_MOVE && tac->type <= TAC_NE) && tac->type != TAC_VECTOR_INDEX) return false;
+    Symbol* res = (Symbol*)tac->res;
+    if (!res || res->nature != SYMBOL_TEMP) return false;
+    int index = livenessIndex(live, res);
+    if (index < 0 || writes->hoisted[index] == writes->current || writes->writes[index] != 1) return false;
+    if (tac->type == TAC_VECTOR_INDEX && !coversExits && !licmSafeIndex(tac)) return false;
+    if (!licmInvariant(live, writes, (Symbol*)tac->op1)) return false;
+    if (tac->type != TAC_MOVE && !licmInvariant(live, writes, (Symbol*)tac->op2)) return false;
+    if (index < live->blockCount) {
+        for (int e : exits) {
+            if (livenessTest(livenessIn(live, e), index)) return false;
+        }
+    }
+    return true;
+}
+
+// Cabeçalho de while que pode ser repetido no pré-cabeçalho como guarda:
+// só cálculos em temporários e o IFZ que sai do laço
+static bool licmGuardable(const CFG* cfg, const LicmWrites* writes, const BasicBlock& header) {
+    if (header.last->type != TAC_IFZ) return false;
+    if (writes->inLoop[cfgBlockOf(cfg, (Symbol*)header.last->res)] == writes->current) return false;
+    for (TAC* tac = header.first->next; tac != header.last; tac = tac->next) {
+        if (tac->type == TAC_SYMBOL) continue;
+        if (!(tac->type >= TAC_MOVE && tac->type <= TAC_NE) && tac->type != TAC_VECTOR_INDEX) return false;
+        if (((Symbol*)tac->res)->nature != SYMBOL_TEMP) return false;
+    }
+    return true;
+}
+
+// Copia o teste do cabeçalho para antes do label, com temporários novos: o
+// que for movido depois dela só executa se o laço executar
+static void licmEmitGuard(const BasicBlock& header) {
+    std::vector<std::pair<Symbol*, Symbol*> > renamed;
+    for (TAC* tac = header.first->next; ; tac = tac->next) {
+        if (tac->type != TAC_SYMBOL) {
+            TAC* copy = tacCreate(tac->type, tac->res, tac->op1, tac->op2);
+            for (const std::pair<Symbol*, Symbol*>& r : renamed) {
+                if (copy->op1 == r.first) copy->op1 = r.second;
+                if (copy->op2 == r.first) copy->op2 = r.second;
+            }
+            if (tac->type != TAC_IFZ) {
+                Symbol* temp = makeTemp(((Symbol*)tac->res)->dataType);
+                renamed.push_back(std::make_pair((Symbol*)tac->res, temp));
+                copy->res = temp;
+            }
+            optInsertBefore(copy, header.first);
+        }
+        if (tac == header.last) break;
+    }
+}
+
+// Move as TACs invariantes de um laço. Devolve quantas saíram
+static int optHoistLoop(const CFG* cfg, const Liveness* live, LicmWrites* writes, int l,
+                        const std::vector<int>& members, LicmStats* stats) {
+    const Loop& loop = cfg->loops[l];
+    const BasicBlock& header = cfg->blocks[loop.header];
+    writes->current++;
+    writes->call = false;
+    for (int b : members) writes->inLoop[b] = writes->current;
+    if (optPreheader(cfg, loop, writes->inLoop, writes->current) < 0) return 0;
+
+    // Escritas do laço, saídas, blocos que saem dele (RET inclusive) e
+    // blocos com aresta de volta
+    std::vector<int> exits, exiting, latches;
+    for (int b : members) {
+        const BasicBlock& block = cfg->blocks[b];
+        for (TAC* tac = block.first; ; tac = tac->next) {
+            Symbol* def = tacOperands(tac).def;
+            if (tac->type == TAC_VECTOR_ASSIGN || tac->type == TAC_VECTOR_INIT) def = (Symbol*)tac->res;
+            if (tac->type == TAC_POINTER_STORE) def = (Symbol*)tac->op2;
+            if (tac->type == TAC_CALL) writes->call = true;
+            int index = livenessIndex(live, def);
+            if (index >= 0) {
+                if (writes->stamp[index] != writes->current) {
+                    writes->stamp[index] = writes->current;
+                    writes->writes[index] = 0;
+                }
+                writes->writes[index]++;
+            }
+            if (tac == block.last) break;
+        }
+        bool leaves = block.last->type == TAC_RET;
+        for (int s : block.succ) {
+            if (s == loop.header) latches.push_back(b);
+            if (writes->inLoop[s] != writes->current) {
+                exits.push_back(s);
+                leaves = true;
+            }
+        }
+        if (leaves) exiting.push_back(b);
+    }
+
+    // Blocos que executam sempre que o laço é iniciado: dominam as saídas
+    // ou, com a guarda, as arestas de volta e as saídas fora do cabeçalho
+    bool guardable = licmGuardable(cfg, writes, header);
+    std::vector<char> always(members.size(), 1), guarded(members.size(), guardable);
+    for (size_t i = 0; i < members.size(); i++) {
+        for (int x : exiting) {
+            if (!cfgDominates(cfg, members[i], x)) {
+                always[i] = 0;
+                if (x != loop.header) guarded[i] = 0;
+            }
+        }
+        for (int x : latches) {
+            if (!cfgDominates(cfg, members[i], x)) guarded[i] = 0;
+        }
+    }
+
+    // Rodadas até nenhuma TAC nova ficar invariante
+    std::vector<TAC*> hoist;
+    bool needGuard = false;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < members.size(); i++) {
+            const BasicBlock& block = cfg->blocks[members[i]];
+            for (TAC* tac = block.first; ; tac = tac->next) {
+                if (licmHoistable(live, writes, tac, exits, always[i] || guarded[i])) {
+                    writes->hoisted[livenessIndex(live, (Symbol*)tac->res)] = writes->current;
+                    hoist.push_back(tac);
+                    if (tac->type == TAC_VECTOR_INDEX && !always[i] && !licmSafeIndex(tac)) needGuard = true;
+                    changed = true;
+                }
+                if (tac == block.last) break;
+            }
+        }
+    }
+
+    if (hoist.empty()) return 0;
+    if (needGuard) {
+        licmEmitGuard(header);
+        stats->guarded++;
+    }
+    // A prova de limites valia sob os desvios do laço: fora dele o acesso
+    // volta a ser verificado
+    for (TAC* tac : hoist) {
+        tac->inBounds = false;
+        optMoveBefore(tac, header.first);
+    }
+    stats->loops++;
+    return (int)hoist.size();
+}
+
+static void optLicmFunction(TAC* begin) {
+    CFG* cfg = cfgBuild(begin);
+    LicmStats stats = {0, 0, 0};
+    int depth = 0;
+    for (const Loop& loop : cfg->loops) depth = std::max(depth, loop.depth);
+
+    for (; depth >= 1; depth--) {
+        Liveness* live = livenessCompute(cfg);
+        LicmWrites writes;
+        writes.stamp.assign(live->count, 0);
+        writes.writes.assign(live->count, 0);
+        writes.hoisted.assign(live->count, 0);
+        writes.inLoop.assign(cfg->blocks.size(), 0);
+        writes.current = 0;
+
+        // Blocos de cada laço (em ordem de lista)
+        std::vector<std::vector<int> > members(cfg->loops.size());
+        for (const BasicBlock& block : cfg->blocks) {
+            if (block.rpo < 0) continue;
+            for (int l = block.loop; l >= 0; l = cfg->loops[l].parent) members[l].push_back(block.id);
+        }
+
+        int moved = 0;
+        for (size_t l = 0; l < cfg->loops.size(); l++) {
+            if (cfg->loops[l].depth != depth) continue;
+            moved += optHoistLoop(cfg, live, &writes, (int)l, members[l], &stats);
+        }
+        livenessFree(live);
+        stats.hoisted += moved;
+        if (moved > 0 && depth > 1) {
+            cfgFree(cfg);
+            cfg = cfgBuild(begin);
+        }
+    }
+
+    if (opt_stats) {
+        fprintf(stderr, "Loop-invariant code motion for '%s': %d TACs hoisted from %d loops (%d guarded)\n",
+                cfg->function->text.c_str(), stats.hoisted, stats.loops, stats.guarded);
+    }
+    cfgFree(cfg);
+}
+
+static void optLicm(TAC* head) {
+    std::vector<TAC*> functions;
+    optSplit(head, NULL, &functions);
+    for (TAC* begin : functions) optLicmFunction(begin);
+}
+
+// Vetorização de laços elemento a elemento. Um while mais interno com
+// cabeçalho i < n (ou i <= literal) e um único bloco de corpo, em que todo
+// acesso a vetor é v[i] provado nos limites, os valores só se combinam por
+// ADD, SUB, MUL e DIV e o corpo termina em i = i + 1, ganha no
+// pré-cabeçalho uma TAC SIMD_LOOP i, n com uma cópia de uma iteração (o
+// kernel). O backend roda o kernel em blocos de elementos com SSE2 ou AVX2,
+// escolhido pelo cpuid na entrada do programa, e deixa em i o início do
+// resto, que o laço escalar original termina. Os elementos são
+// independentes (todo acesso é na posição i e vetores globais distintos não
+// se sobrepõem) e cada um passa pelas mesmas operações, na mesma ordem, que
+// no laço escalar. Os vetores do kernel têm o mesmo tipo de elemento: int
+// (ADD, SUB e MUL nos 32 bits guardados), char ou byte (ADD e SUB nos 8
+// bits) ou real (as quatro operações). Os demais operandos são literais,
+// variáveis que o laço não escreve e temporários calculados antes dele
+
+static const int SIMD_REGISTERS = 14;   // xmm2..xmm15: temporários do kernel e valores fixos
+static const int SIMD_VECTORS = 6;      // registradores de base dos vetores no backend
+
+// Tipo de elemento dos vetores do kernel: 1, 4 ou 8 (real) bytes
+static int simdClass(Symbol* vector) {
+    if (vector->dataType == DATATYPE_REAL) return 8;
+    if (vector->dataType == DATATYPE_INT) return 4;
+    if (vector->dataType == DATATYPE_STRING) return 0;
+    return asmElementSize(vector->dataType) == 1 ? 1 : 0;
+}
+
+static bool simdReal(Symbol* s) {
+    return s->type == LIT_REAL || (s->type != LIT_INT && s->type != LIT_CHAR && s->dataType == DATATYPE_REAL);
+}
+
+// Operando fixo durante o laço: literal, variável escalar que não é a de
+// indução (o corpo só escreve ela e vetores) ou temporário de fora do corpo
+static bool simdInvariant(Symbol* s, Symbol* iv, const std::vector<Symbol*>& bodyTemps) {
+    if (s->type == LIT_INT || s->type == LIT_CHAR || s->type == LIT_REAL) return true;
+    if (s->type == LIT_STRING || s == iv || s->dataType == DATATYPE_STRING) return false;
+    if (s->nature == SYMBOL_TEMP) return std::find(bodyTemps.begin(), bodyTemps.end(), s) == bodyTemps.end();
+    return s->type == TK_IDENTIFIER && s->nature == SYMBOL_SCALAR;
+}
+
+// Tenta vetorizar o laço de cabeçalho header e corpo body. uses: usos de
+// cada temporário da função (por número - tempBase)
+static bool simdVectorize(const CFG* cfg, int header, int body, const std::vector<int>& uses, int tempBase) {
+    const BasicBlock& head = cfg->blocks[header];
+    const BasicBlock& block = cfg->blocks[body];
+    if (head.last->type != TAC_IFZ || block.last->type != TAC_JUMP || block.pred.size() != 1 ||
+        cfgBlockOf(cfg, (Symbol*)head.last->res) == body) return false;
+
+    // Cabeçalho: LABEL; t = i < n; IFZ t (i <= n, n > i e n >= i também servem)
+    Symbol* cond = (Symbol*)head.last->op1;
+    TAC* test = NULL;
+    for (TAC* tac = head.first->next; tac != head.last; tac = tac->next) {
+        if (tac->type == TAC_SYMBOL) continue;
+        if (test || tac->res != cond) return false;
+        test = tac;
+    }
+    if (!test || cond->nature != SYMBOL_TEMP || uses[cond->number - tempBase] != 1) return false;
+    Symbol* iv;
+    Symbol* bound;
+    bool inclusive;
+    if (test->type == TAC_LT || test->type == TAC_LE) {
+        iv = (Symbol*)test->op1;
+        bound = (Symbol*)test->op2;
+        inclusive = test->type == TAC_LE;
+    } else if (test->type == TAC_GT || test->type == TAC_GE) {
+        iv = (Symbol*)test->op2;
+        bound = (Symbol*)test->op1;
+        inclusive = test->type == TAC_GE;
+    } else {
+        return false;
+    }
+    if (iv->type != TK_IDENTIFIER || iv->nature != SYMBOL_SCALAR || iv->dataType != DATATYPE_INT || bound == iv)
+        return false;
+    ConstValue last;
+    if (inclusive) {
+        if (!constOfLiteral(bound, &last) || last.real) return false;
+        last.i++;
+        bound = constLiteral(last, DATATYPE_INT);
+    }
+
+    // Fim do corpo: ADD t, i, 1; MOVE i, t (ou ADD i, i, 1) e o JUMP de volta
+    TAC* step = block.last->prev;
+    while (step != block.first && step->type == TAC_SYMBOL) step = step->prev;
+    if (step->type == TAC_MOVE && step->res == iv) {
+        Symbol* next = (Symbol*)step->op1;
+        if (next->nature != SYMBOL_TEMP || uses[next->number - tempBase] != 1 || step == block.first) return false;
+        step = step->prev;
+        while (step != block.first && step->type == TAC_SYMBOL) step = step->prev;
+        if (step->res != next) return false;
+    } else if (step->res != iv) {
+        return false;
+    }
+    if (step->type != TAC_ADD || step->op1 != iv || ((Symbol*)step->op2)->type != LIT_INT ||
+        strtol(((Symbol*)step->op2)->text.c_str(), NULL, 10) != 1) return false;
+
+    // Corpo antes do passo: acessos em v[i] e operações entre temporários
+    // do corpo e valores fixos
+    std::vector<Symbol*> bodyTemps;
+    for (TAC* tac = block.first; tac != step; tac = tac->next) {
+        Symbol* def = tacOperands(tac).def;
+        if (def && def->nature == SYMBOL_TEMP) bodyTemps.push_back(def);
+    }
+    std::vector<TAC*> steps;
+    std::vector<Symbol*> defined, fixed, vectors;
+    int width = 0;
+    for (TAC* tac = block.first; tac != step; tac = tac->next) {
+        if (tac->type == TAC_SYMBOL || tac->type == TAC_LABEL) continue;
+        Symbol* res = (Symbol*)tac->res;
+        Symbol* operands[2] = {NULL, NULL};
+        Symbol* vector = NULL;
+        switch (tac->type) {
+            case TAC_VECTOR_INDEX:
+                if (tac->op2 != iv || !tac->inBounds) return false;
+                vector = (Symbol*)tac->op1;
+                break;
+            case TAC_VECTOR_ASSIGN:
+                if (tac->op1 != iv || !tac->inBounds) return false;
+                vector = res;
+                res = NULL;
+                operands[0] = (Symbol*)tac->op2;
+                break;
+            case TAC_MOVE:
+            case TAC_ADD:
+            case TAC_SUB:
+            case TAC_MUL:
+            case TAC_DIV:
+                operands[0] = (Symbol*)tac->op1;
+                operands[1] = (Symbol*)tac->op2;
+                break;
+            default:
+                return false;
+        }
+        if (vector) {
+            int kind = simdClass(vector);
+            if (kind == 0 || (width && kind != width)) return false;
+            width = kind;
+            if (std::find(vectors.begin(), vectors.end(), vector) == vectors.end()) vectors.push_back(vector);
+        }
+        for (Symbol* operand : operands) {
+            if (!operand || std::find(defined.begin(), defined.end(), operand) != defined.end()) continue;
+            if (!simdInvariant(operand, iv, bodyTemps)) return false;
+            if (std::find(fixed.begin(), fixed.end(), operand) == fixed.end()) fixed.push_back(operand);
+        }
+        if (res) {
+            // Temporário definido uma vez e lido só no corpo
+            if (res->nature != SYMBOL_TEMP || std::find(defined.begin(), defined.end(), res) != defined.end() ||
+                defined.size() + fixed.size() >= (size_t)SIMD_REGISTERS) return false;
+            int inside = 0;
+            for (TAC* other = block.first; other != block.last; other = other->next) {
+                void** fields[2];
+                int count = tacUseFields(other, fields);
+                for (int k = 0; k < count; k++) {
+                    if (*fields[k] == res) inside++;
+                }
+            }
+            if (inside != uses[res->number - tempBase]) return false;
+            defined.push_back(res);
+        }
+        steps.push_back(tac);
+    }
+    if (width == 0 || vectors.size() > (size_t)SIMD_VECTORS || defined.size() + fixed.size() > (size_t)SIMD_REGISTERS)
+        return false;
+
+    // Tipos: reais só com vetores de real; inteiros nunca passam por real, e
+    // vetores de 1 byte só somam e subtraem
+    for (TAC* tac : steps) {
+        Symbol* res = (Symbol*)tac->res;
+        if (tac->type != TAC_VECTOR_ASSIGN && (res->dataType == DATATYPE_REAL) != (width == 8)) return false;
+        if (width == 1 && (tac->type == TAC_MUL || tac->type == TAC_DIV)) return false;
+        if (width != 8 && tac->type == TAC_DIV) return false;
+    }
+    for (Symbol* s : fixed) {
+        if (width != 8 && simdReal(s)) return false;
+    }
+
+    TacList kernel = tacListEmpty();
+    for (TAC* tac : steps) tacListAppend(&kernel, tacCreate(tac->type, tac->res, tac->op1, tac->op2));
+    TAC* loop = tacCreate(TAC_SIMD_LOOP, iv, bound, NULL);
+    loop->kernel = kernel.head;
+    optInsertBefore(loop, head.first);
+    return true;
+}
+
+static void optVectorizeFunction(TAC* begin) {
+    CFG* cfg = cfgBuild(begin);
+
+    // Usos de cada temporário da função
+    int tempBase = INT_MAX, tempEnd = 0;
+    for (TAC* tac = begin; ; tac = tac->next) {
+        Symbol* res = (Symbol*)tac->res;
+        if (res && res->nature == SYMBOL_TEMP) {
+            tempBase = std::min(tempBase, res->number);
+            tempEnd = std::max(tempEnd, res->number + 1);
+        }
+        if (tac == cfg->end) break;
+    }
+    std::vector<int> uses(tempBase < tempEnd ? tempEnd - tempBase : 0, 0);
+    for (TAC* tac = begin; ; tac = tac->next) {
+        void** fields[2];
+        int count = tacUseFields(tac, fields);
+        for (int k = 0; k < count; k++) {
+            Symbol* s = (Symbol*)*fields[k];
+            if (s && s->nature == SYMBOL_TEMP && s->number >= tempBase && s->number < tempEnd) uses[s->number - tempBase]++;
+        }
+        if (tac == cfg->end) break;
+    }
+
+    // Laços mais internos de dois blocos: cabeçalho e corpo
+    std::vector<int> size(cfg->loops.size(), 0);
+    std::vector<char> inner(cfg->loops.size(), 1);
+    for (const Loop& loop : cfg->loops) {
+        if (loop.parent >= 0) inner[loop.parent] = 0;
+    }
+    for (const BasicBlock& block : cfg->blocks) {
+        if (block.rpo >= 0 && block.loop >= 0) size[block.loop]++;
+    }
+
+    std::vector<int> inLoop(cfg->blocks.size(), -1);
+    int candidates = 0, vectorized = 0;
+    for (size_t l = 0; l < cfg->loops.size(); l++) {
+        if (!inner[l]) continue;
+        candidates++;
+        const Loop& loop = cfg->loops[l];
+        if (size[l] != 2 || loop.header + 1 >= (int)cfg->blocks.size()) continue;
+        inLoop[loop.header] = (int)l;
+        inLoop[loop.header + 1] = (int)l;
+        if (cfg->blocks[loop.header + 1].loop != (int)l || optPreheader(cfg, loop, inLoop, (int)l) < 0) continue;
+        if (simdVectorize(cfg, loop.header, loop.header + 1, uses, tempBase)) vectorized++;
+    }
+
+    if (opt_stats) {
+        fprintf(stderr, "Vectorization for '%s': %d of %d innermost loops vectorized\n",
+                cfg->function->text.c_str(), vectorized, candidates);
+    }
+    cfgFree(cfg);
+}
+
+static void optVectorize(TAC* head) {
+    std::vector<TAC*> functions;
+    optSplit(head, NULL, &functions);
+    for (TAC* begin : functions) optVectorizeFunction(begin);
+}
+
+// Redução de força de variáveis de indução. Nos laços mais internos, uma
+// variável inteira escrita só por i = i + c (c literal, num bloco que
+// executa em toda volta) é uma variável de indução básica. Cada vetor
+// indexado por ela ganha um ponteiro, calculado no pré-cabeçalho com
+// VECTOR_ADDRESS e avançado junto com a variável, e os acessos viram
+// POINTER_LOAD e POINTER_STORE. Como os ponteiros não são verificados, só
+// os acessos que a análise de intervalos provou nos limites são reduzidos;
+// os demais continuam indexados pela variável. Se a variável só serve aos
+// endereços e ao teste do cabeçalho de um while, com passo 1 ou -1, o teste
+// passa a comparar ponteiros e ela deixa de ser atualizada no laço: na
+// saída, se o teste original vale para o valor inicial (o laço executou),
+// ela recebe o valor final. Laços com CALL ficam de fora (a chamada pode ler
+// e escrever a variável)
+
+typedef struct {
+    int accesses;
+    int pointers;
+    int counters;
+} SrStats;
+
+typedef struct {
+    Symbol* vector;
+    Symbol* pointer;
+} SrPointer;
+
+static bool srIntVariable(Symbol* s) {
+    return s && s->type == TK_IDENTIFIER && s->nature == SYMBOL_SCALAR && s->dataType == DATATYPE_INT;
+}
+
+// Índice do acesso a vetor (NULL se a TAC não for um)
+static Symbol* srIndex(TAC* tac) {
+    if (tac->type == TAC_VECTOR_INDEX) return (Symbol*)tac->op2;
+    if (tac->type == TAC_VECTOR_ASSIGN) return (Symbol*)tac->op1;
+    return NULL;
+}
+
+// Marcas de um conjunto de operandos: temporários pelo número, variáveis
+// pelo id. Uma marca só vale se é o laço corrente, como os carimbos de
+// ConstTable, então trocar de laço esvazia o conjunto
+typedef struct {
+    std::vector<int> temp, var;
+} SrMarks;
+
+static void srMark(SrMarks* marks, Symbol* s, int loop) {
+    bool temp = s->nature == SYMBOL_TEMP;
+    std::vector<int>& mark = temp ? marks->temp : marks->var;
+    int key = temp ? s->number : s->id;
+    if (key >= (int)mark.size()) mark.resize(temp ? tacTempCount() : symbolCount(), -1);
+    mark[key] = loop;
+}
+
+static bool srMarked(const SrMarks* marks, Symbol* s, int loop) {
+    bool temp = s->nature == SYMBOL_TEMP;
+    const std::vector<int>& mark = temp ? marks->temp : marks->var;
+    int key = temp ? s->number : s->id;
+    return key < (int)mark.size() && mark[key] == loop;
+}
+
+// Operando que o laço não escreve (o laço não tem CALL)
+static bool srInvariant(Symbol* s, const SrMarks* written, int loop) {
+    if (s->type == LIT_INT) return true;
+    if (s->type != TK_IDENTIFIER && s->nature != SYMBOL_TEMP) return false;
+    if (s->nature != SYMBOL_TEMP && !srIntVariable(s)) return false;
+    if (s->nature == SYMBOL_TEMP && s->dataType != DATATYPE_INT) return false;
+    return !srMarked(written, s, loop);
+}
+
+static TAC* srInsertAfter(TAC* tac, TAC* where) {
+    optInsertBefore(tac, where->next);
+    return tac;
+}
+
+// Reduz os acessos indexados por iv no laço l. written: operandos que o
+// laço escreve (marcados com l). uses: usos de cada temporário da função
+// (por número - tempBase). As TACs do contador eliminado vão para dead e só
+// saem da lista no fim, quando os blocos não são mais percorridos
+static void srReduce(const CFG* cfg, int l, const std::vector<int>& members,
+                     const SrMarks* written, const std::vector<int>& latches, bool onlyHeaderExits,
+                     Symbol* iv, const std::vector<int>& uses, int tempBase, std::vector<TAC*>* dead,
+                     SrStats* stats) {
+    const Loop& loop = cfg->loops[l];
+    const BasicBlock& header = cfg->blocks[loop.header];
+
+    // A única escrita: MOVE iv, t com t = iv + c (ou c + iv, iv - c) antes no bloco
+    TAC* update = NULL;
+    TAC* step = NULL;
+    int updateBlock = -1;
+    int writes = 0;
+    for (int b : members) {
+        const BasicBlock& block = cfg->blocks[b];
+        for (TAC* tac = block.first; ; tac = tac->next) {
+            if (tacOperands(tac).def == iv) {
+                writes++;
+                update = tac;
+                updateBlock = b;
+            }
+            if (tac == block.last) break;
+        }
+    }
+    if (writes != 1 || update->type != TAC_MOVE || ((Symbol*)update->op1)->nature != SYMBOL_TEMP) return;
+    for (TAC* tac = update->prev; tac != cfg->blocks[updateBlock].first->prev; tac = tac->prev) {
+        if (tac->res == update->op1) {
+            step = tac;
+            break;
+        }
+    }
+    if (!step) return;
+    Symbol* a = (Symbol*)step->op1;
+    Symbol* c = (Symbol*)step->op2;
+    long delta;
+    if (step->type == TAC_ADD && a == iv && c->type == LIT_INT) delta = strtol(c->text.c_str(), NULL, 10);
+    else if (step->type == TAC_ADD && c == iv && a->type == LIT_INT) delta = strtol(a->text.c_str(), NULL, 10);
+    else if (step->type == TAC_SUB && a == iv && c->type == LIT_INT) delta = -strtol(c->text.c_str(), NULL, 10);
+    else return;
+    if (delta == 0) return;
+    for (int x : latches) {
+        if (!cfgDominates(cfg, updateBlock, x)) return;
+    }
+
+    // Teste do cabeçalho: t = iv <op> n (ou n <op> iv), só lido pelo IFZ
+    TAC* test = NULL;
+    Symbol* bound = NULL;
+    if (onlyHeaderExits && updateBlock != loop.header && header.last->type == TAC_IFZ) {
+        Symbol* cond = (Symbol*)header.last->op1;
+        for (TAC* tac = header.first; tac != header.last; tac = tac->next) {
+            if (tac->res != cond || tac->type < TAC_LT || tac->type > TAC_NE) continue;
+            Symbol* other = tac->op1 == iv ? (Symbol*)tac->op2 : tac->op2 == iv ? (Symbol*)tac->op1 : NULL;
+            if (other && other != iv && cond->nature == SYMBOL_TEMP && uses[cond->number - tempBase] == 1 &&
+                srInvariant(other, written, l)) {
+                test = tac;
+                bound = other;
+            }
+        }
+    }
+
+    // Acessos indexados por iv e outros usos dela
+    std::vector<SrPointer> pointers;
+    bool otherUses = false;
+    for (int b : members) {
+        const BasicBlock& block = cfg->blocks[b];
+        for (TAC* tac = block.first; ; tac = tac->next) {
+            Symbol* vector = (Symbol*)(tac->type == TAC_VECTOR_INDEX ? tac->op1 : tac->res);
+            if (srIndex(tac) == iv && tac->inBounds) {
+                size_t k = 0;
+                while (k < pointers.size() && pointers[k].vector != vector) k++;
+                if (k == pointers.size()) {
+                    SrPointer pointer = {vector, makeTemp(DATATYPE_INT)};
+                    pointers.push_back(pointer);
+                }
+                if (tac->type == TAC_VECTOR_INDEX) {
+                    tac->type = TAC_POINTER_LOAD;
+                    tac->op1 = pointers[k].pointer;
+                    tac->op2 = vector;
+                } else {
+                    tac->type = TAC_POINTER_STORE;
+                    tac->res = pointers[k].pointer;
+                    tac->op1 = tac->op2;
+                    tac->op2 = vector;
+                    if (tac->op1 == iv) otherUses = true;
+                }
+                stats->accesses++;
+            } else if (tac != step && tac != test) {
+                void** fields[2];
+                int count = tacUseFields(tac, fields);
+                for (int k = 0; k < count; k++) {
+                    if (*fields[k] == iv) otherUses = true;
+                }
+            }
+            if (tac == block.last) break;
+        }
+    }
+    if (pointers.empty()) return;
+    stats->pointers += (int)pointers.size();
+
+    // Ponteiros: calculados antes do laço e avançados junto com iv
+    TAC* after = update;
+    for (const SrPointer& pointer : pointers) {
+        optInsertBefore(tacCreate(TAC_VECTOR_ADDRESS, pointer.pointer, pointer.vector, iv), header.first);
+        ConstValue bytes = {false, delta * asmElementSize(pointer.vector->dataType), 0};
+        after = srInsertAfter(tacCreate(TAC_ADD, pointer.pointer, pointer.pointer,
+                                        constLiteral(bytes, DATATYPE_INT)), after);
+    }
+
+    // Contador eliminado: só com passo 1 para < e <=, -1 para > e >=
+    if (!test || otherUses || uses[((Symbol*)step->res)->number - tempBase] != 1) return;
+    TacType type = test->type;
+    if (test->op1 != iv) {
+        if (type == TAC_LT) type = TAC_GT;
+        else if (type == TAC_GT) type = TAC_LT;
+        else if (type == TAC_LE) type = TAC_GE;
+        else if (type == TAC_GE) type = TAC_LE;
+    }
+    long adjust;
+    if (delta == 1 && type == TAC_LT) adjust = 0;
+    else if (delta == 1 && type == TAC_LE) adjust = 1;
+    else if (delta == -1 && type == TAC_GT) adjust = 0;
+    else if (delta == -1 && type == TAC_GE) adjust = -1;
+    else return;
+    int exit = cfgBlockOf(cfg, (Symbol*)header.last->res);
+    if (cfg->blocks[exit].pred.size() != 1 || cfg->blocks[exit].first->type != TAC_LABEL) return;
+
+    Symbol* end = makeTemp(DATATYPE_INT);
+    optInsertBefore(tacCreate(TAC_VECTOR_ADDRESS, end, pointers[0].vector, bound), header.first);
+
+    // Na saída: if (iv <op> n) iv = n + ajuste
+    Symbol* skip = makeLabel();
+    Symbol* holds = makeTemp(((Symbol*)test->res)->dataType);
+    TAC* fix = srInsertAfter(tacCreate(test->type, holds, test->op1, test->op2), cfg->blocks[exit].first);
+    fix = srInsertAfter(tacCreate(TAC_IFZ, skip, holds, NULL), fix);
+    Symbol* last = bound;
+    if (adjust != 0) {
+        ConstValue one = {false, 1, 0};
+        last = makeTemp(DATATYPE_INT);
+        fix = srInsertAfter(tacCreate(adjust > 0 ? TAC_ADD : TAC_SUB, last, bound, constLiteral(one, DATATYPE_INT)), fix);
+    }
+    fix = srInsertAfter(tacCreate(TAC_MOVE, iv, last, NULL), fix);
+    srInsertAfter(tacCreate(TAC_LABEL, skip, NULL, NULL), fix);
+
+    if (test->op1 == iv) {
+        test->op1 = pointers[0].pointer;
+        test->op2 = end;
+    } else {
+        test->op1 = end;
+        test->op2 = pointers[0].pointer;
+    }
+    dead->push_back(update);
+    dead->push_back(step);
+    stats->counters++;
+}
+
+static void optStrengthReduceFunction(TAC* begin) {
+    CFG* cfg = cfgBuild(begin);
+    SrStats stats = {0, 0, 0};
+
+    // Usos de cada temporário da função
+    int tempBase = INT_MAX, tempEnd = 0;
+    for (TAC* tac = begin; ; tac = tac->next) {
+        Symbol* res = (Symbol*)tac->res;
+        if (res && res->nature == SYMBOL_TEMP) {
+            tempBase = std::min(tempBase, res->number);
+            tempEnd = std::max(tempEnd, res->number + 1);
+        }
+        if (tac == cfg->end) break;
+    }
+    std::vector<int> uses(tempBase < tempEnd ? tempEnd - tempBase : 0, 0);
+    for (TAC* tac = begin; ; tac = tac->next) {
+        void** fields[2];
+        int count = tacUseFields(tac, fields);
+        for (int k = 0; k < count; k++) {
+            Symbol* s = (Symbol*)*fields[k];
+            if (s && s->nature == SYMBOL_TEMP && s->number >= tempBase && s->number < tempEnd) uses[s->number - tempBase]++;
+        }
+        if (tac == cfg->end) break;
+    }
+
+    // Blocos de cada laço; só os laços mais internos são reduzidos
+    std::vector<std::vector<int> > members(cfg->loops.size());
+    std::vector<char> inner(cfg->loops.size(), 1);
+    for (const Loop& loop : cfg->loops) {
+        if (loop.parent >= 0) inner[loop.parent] = 0;
+    }
+    for (const BasicBlock& block : cfg->blocks) {
+        if (block.rpo >= 0 && block.loop >= 0) members[block.loop].push_back(block.id);
+    }
+
+    std::vector<int> inLoop(cfg->blocks.size(), -1);
+    SrMarks written, candidate;
+    std::vector<TAC*> dead;
+    for (size_t l = 0; l < cfg->loops.size(); l++) {
+        if (!inner[l]) continue;
+        const Loop& loop = cfg->loops[l];
+        for (int b : members[l]) inLoop[b] = (int)l;
+        if (optPreheader(cfg, loop, inLoop, (int)l) < 0) continue;
+
+        // Escritas, candidatas (índices de acessos), saídas e arestas de volta
+        std::vector<Symbol*> candidates;
+        std::vector<int> latches;
+        bool call = false, onlyHeaderExits = true;
+        for (int b : members[l]) {
+            const BasicBlock& block = cfg->blocks[b];
+            for (TAC* tac = block.first; ; tac = tac->next) {
+                if (tac->type == TAC_CALL) call = true;
+                Symbol* def = tacOperands(tac).def;
+                if (def) srMark(&written, def, (int)l);
+                Symbol* index = srIndex(tac);
+                if (srIntVariable(index) && !srMarked(&candidate, index, (int)l)) {
+                    srMark(&candidate, index, (int)l);
+                    candidates.push_back(index);
+                }
+                if (tac == block.last) break;
+            }
+            if (block.last->type == TAC_RET && b != loop.header) onlyHeaderExits = false;
+            for (int s : block.succ) {
+                if (s == loop.header) latches.push_back(b);
+                if (inLoop[s] != (int)l && b != loop.header) onlyHeaderExits = false;
+            }
+        }
+        if (call) continue;
+        for (Symbol* iv : candidates) {
+            srReduce(cfg, (int)l, members[l], &written, latches, onlyHeaderExits, iv, uses, tempBase, &dead, &stats);
+        }
+    }
+    for (TAC* tac : dead) tacRemove(tac);
+
+    if (opt_stats) {
+        fprintf(stderr, "Strength reduction for '%s': %d accesses through %d pointers, %d counters eliminated\n",
+                cfg->function->text.c_str(), stats.accesses, stats.pointers, stats.counters);
+    }
+    cfgFree(cfg);
+}
+
+static void optStrengthReduce(TAC* head) {
+    std::vector<TAC*> functions;
+    optSplit(head, NULL, &functions);
+    for (TAC* begin : functions) optStrengthReduceFunction(begin);
+}
+
+// Otimização peephole sobre o programa inteiro. Uma janela de duas TACs
+// (as TAC_SYMBOL, que não geram código, ficam de fora) desliza pela lista
+// e cada regra da tabela tenta reescrevê-la; depois de uma reescrita a
+// janela recua uma TAC. Um label que perde o último desvio volta a ser
+// visto no fim, só na vizinhança dele. Toda reescrita remove uma TAC ou
+// encurta um desvio, então o ponto fixo sai em tempo linear. Labels
+// vizinhos se fundem: o removido vira apelido do outro, e os desvios são
+// acertados quando lidos e numa passada final
+
+typedef struct {
+    std::vector<TAC*> label;        // TAC de cada label (por número; NULL se removido)
+    std::vector<int> refs;          // desvios para cada label
+    std::vector<int> alias;         // label em que cada um foi fundido (-1: nenhum)
+    std::vector<int> seen;          // labels já visitados na cadeia de saltos corrente
+    int stamp;
+    std::vector<int> uses;          // usos de cada temporário (por número)
+    std::vector<int> revisit;       // labels que ficaram sem desvios
+} Peephole;
+
+// Tenta a regra na janela que começa em tac. Devolve a TAC em que a janela
+// recomeça, ou NULL se a regra não se aplica
+typedef TAC* (*PeepholeApply)(Peephole* ph, TAC* tac);
+
+typedef struct {
+    const char* name;
+    PeepholeApply apply;
+    int hits;
+} PeepholeRule;
+
+static TAC* phNext(TAC* tac) {
+    for (tac = tac->next; tac && tac->type == TAC_SYMBOL; tac = tac->next) {}
+    return tac;
+}
+
+// TAC anterior que gera código (ou a sentinela do início)
+static TAC* phPrev(TAC* tac) {
+    for (tac = tac->prev; tac->prev && tac->type == TAC_SYMBOL; tac = tac->prev) {}
+    return tac;
+}
+
+static int phFind(Peephole* ph, int n) {
+    int root = n;
+    while (ph->alias[root] >= 0) root = ph->alias[root];
+    while (ph->alias[n] >= 0) {
+        int next = ph->alias[n];
+        ph->alias[n] = root;
+        n = next;
+    }
+    return root;
+}
+
+// Label de destino do desvio, já acertado se o original foi fundido
+static int phTarget(Peephole* ph, TAC* tac) {
+    int n = phFind(ph, ((Symbol*)tac->res)->number);
+    tac->res = ph->label[n]->res;
+    return n;
+}
+
+static void phUnref(Peephole* ph, int n) {
+    if (--ph->refs[n] == 0) ph->revisit.push_back(n);
+}
+
+static void phRemove(Peephole* ph, TAC* tac) {
+    if (tac->type == TAC_JUMP || tacIsConditionalJump(tac)) phUnref(ph, phTarget(ph, tac));
+    if (tac->type == TAC_LABEL) ph->label[((Symbol*)tac->res)->number] = NULL;
+    void** fields[2];
+    int count = tacUseFields(tac, fields);
+    for (int k = 0; k < count; k++) {
+        Symbol* s = (Symbol*)*fields[k];
+        if (s && s->nature == SYMBOL_TEMP) ph->uses[s->number]--;
+    }
+    tacRemove(tac);
+}
+
+static bool phIsTemp(Symbol* s) {
+    return s && s->nature == SYMBOL_TEMP;
+}
+
+// JUMP para um dos labels logo adiante
+static TAC* phJumpToNext(Peephole* ph, TAC* tac) {
+    if (tac->type != TAC_JUMP) return NULL;
+    int target = phTarget(ph, tac);
+    for (TAC* next = phNext(tac); next && next->type == TAC_LABEL; next = phNext(next)) {
+        if (((Symbol*)next->res)->number != target) continue;
+        TAC* back = phPrev(tac);
+        phRemove(ph, tac);
+        return back;
+    }
+    return NULL;
+}
+
+// Desvio para um label seguido de JUMP: vai direto ao fim da cadeia
+static TAC* phJumpToJump(Peephole* ph, TAC* tac) {
+    if (tac->type != TAC_JUMP && !tacIsConditionalJump(tac)) return NULL;
+    int target = phTarget(ph, tac);
+    int final = target;
+    ph->stamp++;
+    for (;;) {
+        ph->seen[final] = ph->stamp;
+        TAC* next = phNext(ph->label[final]);
+        if (!next || next->type != TAC_JUMP) break;
+        int after = phTarget(ph, next);
+        if (ph->seen[after] == ph->stamp) break;
+        final = after;
+    }
+    if (final == target) return NULL;
+    phUnref(ph, target);
+    ph->refs[final]++;
+    tac->res = ph->label[final]->res;
+    return tac;
+}
+
+// TAC depois de JUMP ou RET que nenhum desvio alcança
+static TAC* phUnreachable(Peephole* ph, TAC* tac) {
+    if (tac->type != TAC_JUMP && tac->type != TAC_RET) return NULL;
+    TAC* next = phNext(tac);
+    if (!next || next->type == TAC_LABEL || next->type == TAC_ENDFUN || next->type == TAC_BEGINFUN) return NULL;
+    phRemove(ph, next);
+    return tac;
+}
+
+// Dois labels seguidos: o segundo vira apelido do primeiro
+static TAC* phAdjacentLabels(Peephole* ph, TAC* tac) {
+    if (tac->type != TAC_LABEL) return NULL;
+    TAC* next = phNext(tac);
+    if (!next || next->type != TAC_LABEL) return NULL;
+    int kept = ((Symbol*)tac->res)->number;
+    int merged = ((Symbol*)next->res)->number;
+    ph->alias[merged] = kept;
+    ph->refs[kept] += ph->refs[merged];
+    ph->refs[merged] = 0;
+    ph->label[merged] = NULL;
+    tacRemove(next);
+    return tac;
+}
+
+static TAC* phUnusedLabel(Peephole* ph, TAC* tac) {
+    if (tac->type != TAC_LABEL || ph->refs[((Symbol*)tac->res)->number] > 0) return NULL;
+    TAC* back = phPrev(tac);
+    phRemove(ph, tac);
+    return back;
+}
+
+static TAC* phSelfMove(Peephole* ph, TAC* tac) {
+    if (tac->type != TAC_MOVE || tac->res != tac->op1) return NULL;
+    TAC* back = phPrev(tac);
+    phRemove(ph, tac);
+    return back;
+}
+
+// Representação no backend: real, string ou inteiro
+static int phKind(DataType type) {
+    return type == DATATYPE_REAL ? 2 : type == DATATYPE_STRING ? 1 : 0;
+}
+
+// t = ...; MOVE x, t com t lido só ali: o resultado vai direto para x. Os
+// temporários guardam 64 bits e só convertem entre inteiro e real, então
+// basta que t e x tenham a mesma representação
+static TAC* phMoveInto(Peephole* ph, TAC* tac) {
+    bool computes = (tac->type >= TAC_MOVE && tac->type <= TAC_NE) || tac->type == TAC_VECTOR_INDEX ||
+                    tac->type == TAC_POINTER_LOAD;
+    Symbol* temp = (Symbol*)tac->res;
+    if (!computes || !phIsTemp(temp) || ph->uses[temp->number] != 1) return NULL;
+    TAC* next = phNext(tac);
+    if (!next || next->type != TAC_MOVE || next->op1 != temp) return NULL;
+    Symbol* dst = (Symbol*)next->res;
+    if (phKind(dst->dataType) != phKind(temp->dataType)) return NULL;
+    tac->res = dst;
+    ph->uses[temp->number] = 0;
+    tacRemove(next);
+    return phPrev(tac);
+}
+
+// t = a < b; IFZ L, t com t lido só ali: um desvio IFNLT L, a, b, que o
+// backend gera como cmp e salto condicional sem materializar o booleano
+static TAC* phCompareJump(Peephole* ph, TAC* tac) {
+    if (tac->type < TAC_LT || tac->type > TAC_NE) return NULL;
+    Symbol* temp = (Symbol*)tac->res;
+    if (!phIsTemp(temp) || ph->uses[temp->number] != 1) return NULL;
+    TAC* next = phNext(tac);
+    if (!next || next->type != TAC_IFZ || next->op1 != temp) return NULL;
+    next->type = (TacType)(TAC_IFNLT + (tac->type - TAC_LT));
+    next->op1 = tac->op1;
+    next->op2 = tac->op2;
+    ph->uses[temp->number] = 0;
+    tacRemove(tac);
+    return phPrev(next);
+}
+
+static bool phReal(Symbol* s) {
+    return s->type == LIT_REAL || (s->type != LIT_INT && s->type != LIT_CHAR && s->dataType == DATATYPE_REAL);
+}
+
+// IFNLT L, a, b; JUMP M; L: vira IFNGE M, a, b. Só para inteiros: com reais
+// a negação da comparação não é a comparação oposta (NaN)
+static TAC* phBranchOverJump(Peephole* ph, TAC* tac) {
+    static const TacType inverse[] = {TAC_IFNGE, TAC_IFNLE, TAC_IFNGT, TAC_IFNLT, TAC_IFNNE, TAC_IFNEQ};
+    if (tac->type < TAC_IFNLT || tac->type > TAC_IFNNE) return NULL;
+    if (phReal((Symbol*)tac->op1) || phReal((Symbol*)tac->op2)) return NULL;
+    TAC* jump = phNext(tac);
+    if (!jump || jump->type != TAC_JUMP) return NULL;
+    TAC* label = phNext(jump);
+    int target = phTarget(ph, tac);
+    if (!label || label->type != TAC_LABEL || ((Symbol*)label->res)->number != target) return NULL;
+    int over = phTarget(ph, jump);
+    tac->type = inverse[tac->type - TAC_IFNLT];
+    tac->res = ph->label[over]->res;
+    ph->refs[over]++;
+    phRemove(ph, jump);
+    phUnref(ph, target);
+    return tac;
+}
+
+static PeepholeRule peephole_rules[] = {
+    {"jump to next label", phJumpToNext, 0},
+    {"jump to jump", phJumpToJump, 0},
+    {"unreachable after jump", phUnreachable, 0},
+    {"adjacent labels", phAdjacentLabels, 0},
+    {"unused label", phUnusedLabel, 0},
+    {"self move", phSelfMove, 0},
+    {"temp moved into variable", phMoveInto, 0},
+    {"compare and branch", phCompareJump, 0},
+    {"branch over jump", phBranchOverJump, 0},
+};
+
+// Aplica as regras a partir de tac. limit: para depois de tantas TACs
+// seguidas sem reescrita (0: até o fim da lista)
+static void phRun(Peephole* ph, TAC* tac, int limit) {
+    int quiet = 0;
+    while (tac && (limit == 0 || quiet < limit)) {
+        TAC* back = NULL;
+        for (PeepholeRule& rule : peephole_rules) {
+            back = rule.apply(ph, tac);
+            if (back) {
+                rule.hits++;
+                break;
+            }
+        }
+        quiet = back ? 0 : quiet + 1;
+        tac = back ? back : tac->next;
+    }
+}
+
+static void optPeephole(TAC* head) {
+    Peephole ph;
+    ph.label.assign(tacLabelCount(), (TAC*)NULL);
+    ph.refs.assign(tacLabelCount(), 0);
+    ph.alias.assign(tacLabelCount(), -1);
+    ph.seen.assign(tacLabelCount(), 0);
+    ph.stamp = 0;
+    ph.uses.assign(tacTempCount(), 0);
+    for (PeepholeRule& rule : peephole_rules) rule.hits = 0;
+
+    for (TAC* tac = head; tac; tac = tac->next) {
+        if (tac->type == TAC_LABEL) ph.label[((Symbol*)tac->res)->number] = tac;
+        if (tac->type == TAC_JUMP || tacIsConditionalJump(tac)) ph.refs[((Symbol*)tac->res)->number]++;
+        void** fields[2];
+        int count = tacUseFields(tac, fields);
+        for (int k = 0; k < count; k++) {
+            Symbol* s = (Symbol*)*fields[k];
+            if (phIsTemp(s)) ph.uses[s->number]++;
+        }
+    }
+
+    phRun(&ph, head, 0);
+    while (!ph.revisit.empty()) {
+        TAC* label = ph.label[ph.revisit.back()];
+        ph.revisit.pop_back();
+        if (label) phRun(&ph, phPrev(label), 3);
+    }
+    for (TAC* tac = head; tac; tac = tac->next) {
+        if (tac->type == TAC_JUMP || tacIsConditionalJump(tac)) phTarget(&ph, tac);
+    }
+
+    if (opt_stats) {
+        fprintf(stderr, "Peephole:");
+        for (size_t r = 0; r < sizeof(peephole_rules) / sizeof(peephole_rules[0]); r++) {
+            fprintf(stderr, "%s %d %s", r ? "," : "", peephole_rules[r].hits, peephole_rules[r].name);
+        }
+        fprintf(stderr, "\n");
+    }
+}
+
+// Expansão de funções pequenas (inlining). O corpo do chamado substitui o
+// CALL com temporários e labels novos, reproduzindo o protocolo da chamada:
+// cada ARG captura o valor do argumento onde é avaliado, os parâmetros
+// (variáveis globais) são salvos, recebem os argumentos e voltam ao valor
+// antigo depois do corpo, e cada RET vira MOVE para o temporário do
+// resultado seguido de JUMP para o fim. As funções são visitadas com os
+// chamados antes dos chamadores (componentes fortemente conexas de Tarjan
+// sobre o grafo de chamadas), então o tamanho de um chamado já inclui o que
+// foi expandido nele; funções numa componente com ciclo (recursivas, direta
+// ou mutuamente) nunca são expandidas. Uma chamada é expandida se o corpo
+// cabe no orçamento, multiplicado por 1 + a profundidade de laço da chamada
+// (até 3), e se o programa não passa do dobro do tamanho original
+
+int opt_inline_budget = 24;
+
+typedef struct {
+    TAC* begin;                     // TAC_BEGINFUN
+    int size;                       // TACs do corpo que geram código
+    bool recursive;
+    std::vector<int> callees;
+    int index, low;                 // numeração de Tarjan
+    bool onStack;
+} InlineFunction;
+
+typedef struct {
+    std::vector<InlineFunction> functions;
+    std::unordered_map<Symbol*, int> byName;    // função de cada símbolo
+    std::vector<int> order;                     // chamados antes dos chamadores
+    int growth, limit;                          // TACs acrescentadas e limite
+    int sites;
+} Inliner;
+
+static int inlineSize(TAC* begin) {
+    int size = 0;
+    for (TAC* tac = begin->next; tac && tac->type != TAC_ENDFUN; tac = tac->next) {
+        if (tac->type != TAC_SYMBOL) size++;
+    }
+    return size;
+}
+
+// Componentes fortemente conexas em ordem topológica reversa (iterativo)
+static void inlineOrder(Inliner* in) {
+    typedef struct {
+        int f, next;
+    } Frame;
+    std::vector<InlineFunction>& fn = in->functions;
+    std::vector<int> stack;
+    int counter = 0;
+    for (int root = 0; root < (int)fn.size(); root++) {
+        if (fn[root].index >= 0) continue;
+        std::vector<Frame> frames;
+        Frame first = {root, 0};
+        frames.push_back(first);
+        fn[root].index = fn[root].low = counter++;
+        fn[root].onStack = true;
+        stack.push_back(root);
+        while (!frames.empty()) {
+            Frame& top = frames.back();
+            InlineFunction& f = fn[top.f];
+            if (top.next < (int)f.callees.size()) {
+                int c = f.callees[top.next++];
+                if (fn[c].index < 0) {
+                    fn[c].index = fn[c].low = counter++;
+                    fn[c].onStack = true;
+                    stack.push_back(c);
+                    Frame next = {c, 0};
+                    frames.push_back(next);
+                } else if (fn[c].onStack) {
+                    f.low = std::min(f.low, fn[c].index);
+                }
+                continue;
+            }
+            int done = top.f;
+            if (f.low == f.index) {
+                size_t start = stack.size();
+                while (stack[--start] != done) {}
+                bool cycle = stack.size() - start > 1 ||
+                             std::find(f.callees.begin(), f.callees.end(), done) != f.callees.end();
+                for (size_t k = start; k < stack.size(); k++) {
+                    fn[stack[k]].onStack = false;
+                    fn[stack[k]].recursive = cycle;
+                    in->order.push_back(stack[k]);
+                }
+                stack.resize(start);
+            }
+            frames.pop_back();
+            if (!frames.empty()) {
+                InlineFunction& caller = fn[frames.back().f];
+                caller.low = std::min(caller.low, fn[done].low);
+            }
+        }
+    }
+}
+
+// Operando renomeado na cópia do corpo: temporários e labels ganham novos
+static Symbol* inlineRename(Symbol* s, std::unordered_map<Symbol*, Symbol*>* renamed) {
+    if (!s || (s->nature != SYMBOL_TEMP && s->nature != SYMBOL_LABEL)) return s;
+    Symbol*& copy = (*renamed)[s];
+    if (!copy) copy = s->nature == SYMBOL_TEMP ? makeTemp(s->dataType) : makeLabel();
+    return copy;
+}
+
+// Valores dos argumentos de uma chamada que deixa de existir: cada ARG de
+// variável vira MOVE para um temporário (o valor no ponto em que o ARG era
+// avaliado); os de temporários e literais são retirados. Devolve quantos
+// MOVE ficaram
+static int optCaptureArguments(const std::vector<TAC*>& args, std::vector<Symbol*>* values) {
+    int moves = 0;
+    for (TAC* arg : args) {
+        Symbol* value = (Symbol*)arg->op1;
+        if (value->type == TK_IDENTIFIER && value->nature == SYMBOL_SCALAR) {
+            arg->type = TAC_MOVE;
+            arg->res = makeTemp(value->dataType);
+            values->push_back((Symbol*)arg->res);
+            moves++;
+            continue;
+        }
+        values->push_back(value);
+        tacRemove(arg);
+    }
+    return moves;
+}
+
+// Parâmetros (variáveis globais) da função; false se algum não existe
+static bool optParameters(Symbol* func, std::vector<Symbol*>* params) {
+    for (const Parameter& parameter : func->parameters) {
+        Symbol* param = symbolFind(parameter.name.c_str());
+        if (!param) return false;
+        params->push_back(param);
+    }
+    return true;
+}
+
+// Substitui call (com seus ARGs em args) pelo corpo do chamado. Devolve as
+// TACs acrescentadas (descontadas as removidas)
+static int inlineExpand(TAC* call, const std::vector<TAC*>& args, const std::vector<Symbol*>& params,
+                        TAC* begin) {
+    std::vector<Symbol*> values;
+    int added = optCaptureArguments(args, &values) - (int)args.size() - 1;
+
+    std::vector<Symbol*> saved;
+    for (Symbol* param : params) {
+        saved.push_back(makeTemp(param->dataType));
+        optInsertBefore(tacCreate(TAC_MOVE, saved.back(), param, NULL), call);
+    }
+    for (size_t i = 0; i < params.size(); i++) {
+        optInsertBefore(tacCreate(TAC_MOVE, params[i], values[i], NULL), call);
+    }
+    added += 2 * (int)params.size();
+
+    std::unordered_map<Symbol*, Symbol*> renamed;
+    Symbol* end = makeLabel();
+    for (TAC* tac = begin->next; tac->type != TAC_ENDFUN; tac = tac->next) {
+        if (tac->type == TAC_SYMBOL) continue;
+        if (tac->type == TAC_RET) {
+            if (tac->op1) optInsertBefore(tacCreate(TAC_MOVE, call->res, inlineRename((Symbol*)tac->op1, &renamed), NULL), call);
+            optInsertBefore(tacCreate(TAC_JUMP, end, NULL, NULL), call);
+            added += 2;
+            continue;
+        }
+        optInsertBefore(tacCreate(tac->type, inlineRename((Symbol*)tac->res, &renamed),
+                                  inlineRename((Symbol*)tac->op1, &renamed),
+                                  inlineRename((Symbol*)tac->op2, &renamed)), call);
+        added++;
+    }
+    optInsertBefore(tacCreate(TAC_LABEL, end, NULL, NULL), call);
+    for (size_t i = 0; i < params.size(); i++) {
+        optInsertBefore(tacCreate(TAC_MOVE, params[i], saved[i], NULL), call);
+    }
+    added += 1 + (int)params.size();
+    tacRemove(call);
+    return added;
+}
+
+// Expande as chamadas da função que cabem no orçamento
+static void inlineFunction(Inliner* in, int f) {
+    TAC* begin = in->functions[f].begin;
+    Symbol* caller = (Symbol*)begin->res;
+
+    // Chamadas e seus ARGs (pilha de argumentos como no backend), com a
+    // profundidade de laço de cada uma, antes de mudar a função
+    typedef struct {
+        TAC* call;
+        std::vector<TAC*> args;
+        int depth;
+    } Site;
+    std::vector<Site> sites;
+    CFG* cfg = cfgBuild(begin);
+    std::vector<TAC*> pending;
+    for (const BasicBlock& block : cfg->blocks) {
+        for (TAC* tac = block.first; ; tac = tac->next) {
+            if (tac->type == TAC_ARG) pending.push_back(tac);
+            if (tac->type == TAC_CALL) {
+                Symbol* func = (Symbol*)tac->op1;
+                int count = std::min((int)func->parameters.size(), (int)pending.size());
+                Site site;
+                site.call = tac;
+                site.args.assign(pending.end() - count, pending.end());
+                site.depth = cfgLoopDepth(cfg, block.id);
+                pending.resize(pending.size() - count);
+                if (count == (int)func->parameters.size()) sites.push_back(site);
+            }
+            if (tac == block.last) break;
+        }
+    }
+    cfgFree(cfg);
+
+    std::vector<std::pair<Symbol*, int> > expanded;     // chamados, na ordem da primeira expansão
+    for (Site& site : sites) {
+        Symbol* func = (Symbol*)site.call->op1;
+        std::unordered_map<Symbol*, int>::iterator it = in->byName.find(func);
+        if (it == in->byName.end() || in->functions[it->second].recursive) continue;
+        const InlineFunction& callee = in->functions[it->second];
+        int allowed = opt_inline_budget * (1 + std::min(site.depth, 3));
+        if (callee.size > allowed || in->growth + callee.size > in->limit) continue;
+
+        std::vector<Symbol*> params;
+        if (!optParameters(func, &params)) continue;
+
+        in->growth += inlineExpand(site.call, site.args, params, callee.begin);
+        in->sites++;
+        size_t k = 0;
+        while (k < expanded.size() && expanded[k].first != func) k++;
+        if (k == expanded.size()) expanded.push_back(std::make_pair(func, 0));
+        expanded[k].second++;
+    }
+
+    for (const std::pair<Symbol*, int>& entry : expanded) {
+        if (opt_stats) {
+            fprintf(stderr, "Inlined '%s' into '%s' at %d call sites (%d TACs each)\n", entry.first->text.c_str(),
+                    caller->text.c_str(), entry.second, in->functions[in->byName[entry.first]].size);
+        }
+    }
+    in->functions[f].size = inlineSize(begin);
+}
+
+static void optInline(TAC* head) {
+    if (opt_inline_budget <= 0) return;
+    Inliner in;
+    in.growth = 0;
+    in.sites = 0;
+    in.limit = 0;
+
+    std::vector<TAC*> functions;
+    optSplit(head, NULL, &functions);
+    for (TAC* begin : functions) {
+        InlineFunction f;
+        f.begin = begin;
+        f.size = inlineSize(begin);
+        f.recursive = false;
+        f.index = f.low = -1;
+        f.onStack = false;
+        in.byName[(Symbol*)begin->res] = (int)in.functions.size();
+        in.functions.push_back(f);
+        in.limit += f.size;
+    }
+    for (InlineFunction& f : in.functions) {
+        for (TAC* tac = f.begin->next; tac->type != TAC_ENDFUN; tac = tac->next) {
+            if (tac->type != TAC_CALL) continue;
+            std::unordered_map<Symbol*, int>::iterator it = in.byName.find((Symbol*)tac->op1);
+            if (it != in.byName.end()) f.callees.push_back(it->second);
+        }
+    }
+
+    inlineOrder(&in);
+    int recursive = 0;
+    for (int f : in.order) {
+        if (in.functions[f].recursive) recursive++;
+        inlineFunction(&in, f);
+    }
+    if (opt_stats) {
+        fprintf(stderr, "Inlining: %d call sites expanded, %d recursive functions kept, %+d TACs (budget %d)\n",
+                in.sites, recursive, in.growth, opt_inline_budget);
+    }
+}
+
+// Eliminação de chamadas recursivas em posição de cauda: "t = CALL f; RET t"
+// dentro da própria f vira atribuição dos argumentos aos parâmetros e JUMP
+// para um label logo depois do BEGINFUN, e a recursão passa a rodar em pilha
+// constante. Os argumentos são capturados como no inlining, então a
+// atribuição é paralela (f(n, acc) com parâmetros trocados funciona). Numa
+// chamada de cauda a outra função os parâmetros dela teriam de voltar ao
+// valor antigo no retorno, o que o salto não faz; essas ficam como estão
+static void optTailCallsFunction(TAC* begin) {
+    Symbol* func = (Symbol*)begin->res;
+    std::vector<Symbol*> params;
+    if (!optParameters(func, &params)) return;
+
+    Symbol* entry = NULL;
+    int count = 0;
+    std::vector<TAC*> pending;
+    for (TAC* tac = begin->next; tac->type != TAC_ENDFUN; tac = tac->next) {
+        if (tac->type == TAC_ARG) pending.push_back(tac);
+        if (tac->type != TAC_CALL) continue;
+        Symbol* callee = (Symbol*)tac->op1;
+        int argc = std::min((int)callee->parameters.size(), (int)pending.size());
+        std::vector<TAC*> args(pending.end() - argc, pending.end());
+        pending.resize(pending.size() - argc);
+
+        TAC* ret = tac->next;
+        while (ret->type == TAC_SYMBOL) ret = ret->next;
+        if (callee != func || argc != (int)params.size() || ret->type != TAC_RET || ret->op1 != tac->res) continue;
+
+        if (!entry) {
+            entry = makeLabel();
+            optInsertBefore(tacCreate(TAC_LABEL, entry, NULL, NULL), begin->next);
+        }
+        std::vector<Symbol*> values;
+        optCaptureArguments(args, &values);
+        for (size_t i = 0; i < params.size(); i++) {
+            optInsertBefore(tacCreate(TAC_MOVE, params[i], values[i], NULL), tac);
+        }
+        optInsertBefore(tacCreate(TAC_JUMP, entry, NULL, NULL), tac);
+        TAC* call = tac;
+        tac = tac->prev;
+        tacRemove(ret);
+        tacRemove(call);
+        count++;
+    }
+    if (opt_stats && count > 0) {
+        fprintf(stderr, "Tail calls for '%s': %d self calls turned into jumps\n", func->text.c_str(), count);
+    }
+}
+
+static void optTailCalls(TAC* head) {
+    std::vector<TAC*> functions;
+    optSplit(head, NULL, &functions);
+    for (TAC* begin : functions) optTailCallsFunction(begin);
+}
+
+TAC* optimize(TAC* code) {
+    if (!code) return code;
+
+    // Sentinela antes da primeira TAC: os passos podem retirá-la
+    TAC* head = tacCreate(TAC_SYMBOL, NULL, NULL, NULL);
+    head->next = code;
+    code->prev = head;
+
+    optTailCalls(head);
+    optInline(head);
+    optConstants(head);
+    optSccp(head);
+    optValueNumbering(head);
+    optDeadCode(head);
+    optRanges(head);
+    optLicm(head);
+    optVectorize(head);
+    optStrengthReduce(head);
+    optPeephole(head);
+
+    return tacRemove(head);
+}
@@ -0,0 +1,21 @@
+//
+// opt.hpp - Otimizações sobre as TACs
+//
+
+#ifndef OPT_HPP
+#define OPT_HPP
+
+#include "tacs.hpp"
+
+// Aplica as otimizações ao programa e devolve o novo início da lista (a
+// primeira TAC pode ser removida)
+TAC* optimize(TAC* code);
+
+// Orçamento do inlining: maior corpo (em TACs) expandido numa chamada fora
+// de laços; dentro de laços o limite cresce com a profundidade. 0 desliga
+extern int opt_inline_budget;
+
+// Imprime em stderr um resumo de cada passo (-stats)
+extern bool opt_stats;
+
+#endif // OPT_HPP
@@ -0,0 +1,250 @@
+//
+// ssa.cpp - Forma SSA das funções de TACs
+//
+// Construção de Cytron et al.: phis na fronteira de dominância iterada dos
+// blocos que definem cada operando, podados pela análise de vida (só onde o
+// operando está vivo na entrada), e renomeação numa travessia iterativa da
+// árvore de dominadores com uma pilha de versões por operando.
+//
+// Um CALL define todas as variáveis: os blocos com chamadas entram nos
+// locais de definição de cada variável, e cada versão empilhada guarda
+// quantas chamadas havia no caminho de dominadores quando foi criada. Se
+// houve uma chamada depois, a versão corrente é a própria variável.
+//
+
+#include "ssa.hpp"
+#include "liveness.hpp"
+#include "parser.tab.hpp"
+
+Symbol* ssaOriginal(const Ssa* ssa, Symbol* s) {
+    if (!ssaIsVersion(ssa, s)) return s;
+    return ssa->original[s->number - ssa->versionBase];
+}
+
+bool ssaIsVersion(const Ssa* ssa, Symbol* s) {
+    if (!s || s->nature != SYMBOL_TEMP) return false;
+    int k = s->number - ssa->versionBase;
+    return k >= 0 && k < (int)ssa->original.size();
+}
+
+// Fronteira de dominância (Cooper, Harvey e Kennedy): cada predecessor de
+// uma junção sobe pela árvore de dominadores até o dominador imediato dela
+static void ssaComputeFrontier(Ssa* ssa) {
+    const CFG* cfg = ssa->cfg;
+    ssa->frontier.assign(cfg->blocks.size(), std::vector<int>());
+    for (int b : cfg->order) {
+        const BasicBlock& block = cfg->blocks[b];
+        if (block.pred.size() < 2) continue;
+        for (int p : block.pred) {
+            if (cfg->blocks[p].rpo < 0) continue;
+            for (int runner = p; runner != block.idom && runner >= 0; runner = cfg->blocks[runner].idom) {
+                std::vector<int>& df = ssa->frontier[runner];
+                if (df.empty() || df.back() != b) df.push_back(b);
+            }
+        }
+    }
+}
+
+// Fronteira de dominância iterada de um conjunto de blocos (em result)
+static void ssaIteratedFrontier(const Ssa* ssa, const std::vector<int>& blocks, std::vector<int>* result,
+                                std::vector<int>& mark, int stamp) {
+    std::vector<int> work(blocks);
+    result->clear();
+    while (!work.empty()) {
+        int b = work.back();
+        work.pop_back();
+        for (int f : ssa->frontier[b]) {
+            if (mark[f] == stamp) continue;
+            mark[f] = stamp;
+            result->push_back(f);
+            work.push_back(f);
+        }
+    }
+}
+
+// Operando renomeado: temporário ou variável escalar
+static bool ssaRenamed(Symbol* s) {
+    return s && (s->nature == SYMBOL_TEMP || (s->type == TK_IDENTIFIER && s->nature == SYMBOL_SCALAR));
+}
+
+// Destino escalar da TAC (VECTOR_ASSIGN escreve no vetor, que não é renomeado)
+static Symbol* ssaDef(TAC* tac) {
+    Symbol* def = tacOperands(tac).def;
+    return ssaRenamed(def) ? def : NULL;
+}
+
+// Versão empilhada e número de chamadas no caminho quando foi criada
+typedef struct {
+    Symbol* version;
+    int calls;
+} SsaVersion;
+
+typedef struct {
+    const Liveness* live;
+    std::vector<std::vector<SsaVersion> > stacks;   // por índice de operando
+    int calls;                                      // chamadas no caminho de dominadores
+} SsaRename;
+
+static Symbol* ssaCurrent(const SsaRename* rename, int index) {
+    Symbol* s = rename->live->operands[index];
+    const std::vector<SsaVersion>& stack = rename->stacks[index];
+    if (stack.empty()) return s;
+    const SsaVersion& top = stack.back();
+    if (s->nature != SYMBOL_TEMP && top.calls != rename->calls) return s;
+    return top.version;
+}
+
+static Symbol* ssaNewVersion(Ssa* ssa, SsaRename* rename, Symbol* s, std::vector<int>* pushed) {
+    Symbol* version = makeTemp(s->dataType);
+    ssa->original.push_back(s);
+    int index = livenessIndex(rename->live, s);
+    SsaVersion entry = {version, rename->calls};
+    rename->stacks[index].push_back(entry);
+    pushed->push_back(index);
+    return version;
+}
+
+// Renomeia um bloco: phis, usos e definições das TACs, e os argumentos dos
+// phis dos sucessores. pushed recebe os operandos empilhados
+static void ssaRenameBlock(Ssa* ssa, SsaRename* rename, int b, std::vector<int>* pushed) {
+    const CFG* cfg = ssa->cfg;
+    const BasicBlock& block = cfg->blocks[b];
+
+    for (Phi& phi : ssa->phis[b]) {
+        phi.res = ssaNewVersion(ssa, rename, phi.original, pushed);
+    }
+
+    for (TAC* tac = block.first; ; tac = tac->next) {
+        void** fields[2];
+        int count = tacUseFields(tac, fields);
+        for (int k = 0; k < count; k++) {
+            Symbol* s = (Symbol*)*fields[k];
+            int index = ssaRenamed(s) ? livenessIndex(rename->live, s) : -1;
+            if (index >= 0) *fields[k] = ssaCurrent(rename, index);
+        }
+        if (tac->type == TAC_CALL) rename->calls++;
+        Symbol* def = ssaDef(tac);
+        if (def && livenessIndex(rename->live, def) >= 0) tac->res = ssaNewVersion(ssa, rename, def, pushed);
+        if (tac == block.last) break;
+    }
+
+    for (int s : block.succ) {
+        const std::vector<int>& pred = cfg->blocks[s].pred;
+        int j = 0;
+        while (pred[j] != b) j++;
+        for (Phi& phi : ssa->phis[s]) {
+            phi.args[j] = ssaCurrent(rename, livenessIndex(rename->live, phi.original));
+        }
+    }
+}
+
+Ssa* ssaBuild(CFG* cfg) {
+    Ssa* ssa = new Ssa();
+    ssa->cfg = cfg;
+    ssa->versionBase = tacTempCount();
+    ssa->phiCount = 0;
+    int blocks = (int)cfg->blocks.size();
+    ssa->phis.assign(blocks, std::vector<Phi>());
+    if (cfg->order.empty()) return ssa;
+
+    Liveness* live = livenessCompute(cfg);
+    ssaComputeFrontier(ssa);
+
+    // Blocos que definem cada operando que pode estar vivo entre blocos, e
+    // blocos com chamadas (definem todas as variáveis)
+    std::vector<std::vector<int> > defBlocks(live->blockCount);
+    std::vector<int> callBlocks;
+    for (int b : cfg->order) {
+        const BasicBlock& block = cfg->blocks[b];
+        bool call = false;
+        for (TAC* tac = block.first; ; tac = tac->next) {
+            int index = livenessIndex(live, ssaDef(tac));
+            if (index >= 0 && index < live->blockCount &&
+                (defBlocks[index].empty() || defBlocks[index].back() != b))
+                defBlocks[index].push_back(b);
+            if (tac->type == TAC_CALL) call = true;
+            if (tac == block.last) break;
+        }
+        if (call) callBlocks.push_back(b);
+    }
+
+    // Phis na fronteira iterada, só onde o operando está vivo na entrada
+    std::vector<int> mark(blocks, 0);
+    std::vector<int> placed(blocks, -1);
+    std::vector<int> frontier, callFrontier;
+    int stamp = 0;
+    ssaIteratedFrontier(ssa, callBlocks, &callFrontier, mark, ++stamp);
+    for (int index = 0; index < live->blockCount; index++) {
+        Symbol* s = live->operands[index];
+        if (!ssaRenamed(s)) continue;
+        ssaIteratedFrontier(ssa, defBlocks[index], &frontier, mark, ++stamp);
+        for (int pass = 0; pass < 2; pass++) {
+            const std::vector<int>& where = pass == 0 ? frontier : callFrontier;
+            if (pass == 1 && s->nature == SYMBOL_TEMP) break;
+            for (int b : where) {
+                if (placed[b] == index || !livenessTest(livenessIn(live, b), index)) continue;
+                placed[b] = index;
+                Phi phi;
+                phi.res = NULL;
+                phi.original = s;
+                phi.args.assign(cfg->blocks[b].pred.size(), (Symbol*)NULL);
+                ssa->phis[b].push_back(phi);
+                ssa->phiCount++;
+            }
+        }
+    }
+
+    // Renomeação em pré-ordem da árvore de dominadores
+    std::vector<std::vector<int> > children(blocks);
+    for (int b : cfg->order) {
+        if (cfg->blocks[b].idom >= 0) children[cfg->blocks[b].idom].push_back(b);
+    }
+    SsaRename rename;
+    rename.live = live;
+    rename.stacks.assign(live->count, std::vector<SsaVersion>());
+    rename.calls = 0;
+
+    // Cada quadro guarda o bloco, o próximo filho, o início do seu trecho em
+    // pushed e as chamadas na entrada do bloco
+    typedef struct {
+        int block, child, pushed, calls;
+    } Frame;
+    std::vector<Frame> stack;
+    std::vector<int> pushed;
+    int entry = cfg->order[0];
+    Frame frame = {entry, 0, 0, 0};
+    stack.push_back(frame);
+    ssaRenameBlock(ssa, &rename, entry, &pushed);
+    while (!stack.empty()) {
+        Frame& top = stack.back();
+        if (top.child < (int)children[top.block].size()) {
+            int child = children[top.block][top.child++];
+            Frame next = {child, 0, (int)pushed.size(), rename.calls};
+            stack.push_back(next);
+            ssaRenameBlock(ssa, &rename, child, &pushed);
+            continue;
+        }
+        while ((int)pushed.size() > top.pushed) {
+            rename.stacks[pushed.back()].pop_back();
+            pushed.pop_back();
+        }
+        rename.calls = top.calls;
+        stack.pop_back();
+    }
+
+    livenessFree(live);
+    return ssa;
+}
+
+void ssaDestroy(Ssa* ssa) {
+    // Percorre a lista (não os blocos): os passos sobre a forma SSA podem ter
+    // retirado TACs das pontas dos blocos
+    const CFG* cfg = ssa->cfg;
+    for (TAC* tac = cfg->begin; ; tac = tac->next) {
+        tac->res = ssaOriginal(ssa, (Symbol*)tac->res);
+        tac->op1 = ssaOriginal(ssa, (Symbol*)tac->op1);
+        tac->op2 = ssaOriginal(ssa, (Symbol*)tac->op2);
+        if (tac == cfg->end) break;
+    }
+    delete ssa;
+}
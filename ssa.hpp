@@ -0,0 +1,45 @@
+//
+// ssa.hpp - Forma SSA das funções de TACs
+//
+
+#ifndef SSA_HPP
+#define SSA_HPP
+
+#include <vector>
+#include "cfg.hpp"
+
+// Phi no início de um bloco: res recebe a versão que chega de cada predecessor
+typedef struct {
+    Symbol* res;                    // versão definida pelo phi
+    Symbol* original;               // operando original
+    std::vector<Symbol*> args;      // versão de cada predecessor, na ordem de pred
+} Phi;
+
+// Função em forma SSA. Cada definição de um temporário ou variável escalar
+// ganha uma versão (um temporário novo); os usos leem a versão que os
+// alcança. Na entrada e depois de cada CALL a versão corrente de uma
+// variável é ela mesma (o valor em memória, que a função chamada pode ter
+// escrito). Vetores ficam fora da renomeação
+typedef struct {
+    CFG* cfg;
+    std::vector<std::vector<Phi> > phis;        // phis de cada bloco
+    std::vector<std::vector<int> > frontier;    // fronteira de dominância de cada bloco
+    int versionBase;                            // número do primeiro temporário de versão
+    std::vector<Symbol*> original;              // original de cada versão (número - versionBase)
+    int phiCount;
+} Ssa;
+
+// Coloca a função do CFG em forma SSA (phis podados pela análise de vida)
+Ssa* ssaBuild(CFG* cfg);
+
+// Sai da forma SSA: cada versão volta a ser o operando original e os phis
+// são descartados. Vale enquanto as versões de um mesmo operando não
+// estiverem vivas ao mesmo tempo (SSA convencional), o que os passos que só
+// trocam usos por literais e cortam desvios preservam
+void ssaDestroy(Ssa* ssa);
+
+// Operando original de uma versão (o próprio s se não for versão)
+Symbol* ssaOriginal(const Ssa* ssa, Symbol* s);
+bool ssaIsVersion(const Ssa* ssa, Symbol* s);
+
+#endif // SSA_HPP
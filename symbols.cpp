@@ -6,57 +6,148 @@
 #include "ast.h"
 #include "parser.tab.hpp"
 #include <string>
-#include <map>
+#include <vector>
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 
-// Tabela de símbolos global
-static std::map<std::string, Symbol*> SymbolTable;
+// Tabela de símbolos global: hash com endereçamento aberto (sondagem linear).
+// Cada posição guarda o hash já calculado, então a busca só compara o texto
+// quando os hashes coincidem, e o crescimento não precisa recalcular nada.
+typedef struct {
+    unsigned int hash;
+    Symbol* symbol;     // NULL = posição livre
+} SymbolSlot;
+
+#define SYMBOL_TABLE_INITIAL 1024   // potência de 2
+
+static SymbolSlot* SymbolTable = NULL;
+static unsigned int SymbolTableCapacity = 0;
+
+// Símbolos em ordem de inserção; o índice é o id denso do símbolo
+static std::vector<Symbol*> SymbolsById;
 
 // Contador de erros semânticos
 static int semanticErrors = 0;
 
-// Função para inserir um símbolo na tabela
-Symbol* symbolInsert(int type, const char* text) {
-    std::string key(text);
-    auto it = SymbolTable.find(key);
+// Hash FNV-1a do texto (não precisa de terminador)
+static unsigned int symbolHash(const char* text, int length) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Procura a posição do texto na tabela: a do símbolo, se existir, ou a livre onde entraria
+static SymbolSlot* symbolSlot(const char* text, int length, unsigned int hash) {
+    unsigned int mask = SymbolTableCapacity - 1;
+    unsigned int i = hash & mask;
+    
+    while (SymbolTable[i].symbol) {
+        Symbol* symbol = SymbolTable[i].symbol;
+        if (SymbolTable[i].hash == hash && (int)symbol->text.size() == length &&
+            memcmp(symbol->text.data(), text, length) == 0)
+            break;
+        i = (i + 1) & mask;
+    }
+    return &SymbolTable[i];
+}
+
+// Dobra a capacidade da tabela reaproveitando os hashes guardados
+static void symbolTableGrow(void) {
+    SymbolSlot* old = SymbolTable;
+    unsigned int oldCapacity = SymbolTableCapacity;
+    
+    SymbolTableCapacity = oldCapacity ? oldCapacity * 2 : SYMBOL_TABLE_INITIAL;
+    SymbolTable = (SymbolSlot*)calloc(SymbolTableCapacity, sizeof(SymbolSlot));
+    if (!SymbolTable) {
+        fprintf(stderr, "Erro de memória ao expandir a tabela de símbolos\n");
+        exit(1);
+    }
     
-    if (it != SymbolTable.end())
-        return it->second;
-        
-    Symbol* newSymbol = new Symbol(type, key);
-    SymbolTable[key] = newSymbol;
+    unsigned int mask = SymbolTableCapacity - 1;
+    for (unsigned int j = 0; j < oldCapacity; j++) {
+        if (!old[j].symbol) continue;
+        unsigned int i = old[j].hash & mask;
+        while (SymbolTable[i].symbol) i = (i + 1) & mask;
+        SymbolTable[i] = old[j];
+    }
+    free(old);
+}
+
+// Função para inserir um símbolo na tabela (texto com tamanho, ex.: yytext/yyleng)
+Symbol* symbolInsert(int type, const char* text, int length) {
+    // Mantém a ocupação abaixo de 50% para sondagens curtas
+    if ((SymbolsById.size() + 1) * 2 > SymbolTableCapacity)
+        symbolTableGrow();
+    
+    unsigned int hash = symbolHash(text, length);
+    SymbolSlot* slot = symbolSlot(text, length, hash);
+    
+    if (slot->symbol)
+        return slot->symbol;
+    
+    Symbol* newSymbol = new Symbol(type, std::string(text, length));
+    newSymbol->id = (int)SymbolsById.size();
+    SymbolsById.push_back(newSymbol);
+    
+    slot->hash = hash;
+    slot->symbol = newSymbol;
     return newSymbol;
 }
 
+// Função para inserir um símbolo na tabela
+Symbol* symbolInsert(int type, const char* text) {
+    return symbolInsert(type, text, (int)strlen(text));
+}
+
 // Função para buscar um símbolo na tabela
 Symbol* symbolFind(const char* text) {
-    std::string key(text);
-    auto it = SymbolTable.find(key);
-    
-    if (it != SymbolTable.end())
-        return it->second;
+    if (!SymbolTable) return nullptr;
     
-    return nullptr;
+    int length = (int)strlen(text);
+    return symbolSlot(text, length, symbolHash(text, length))->symbol;
 }
 
 // Função para buscar uma função na tabela de símbolos
 Symbol* findFunction(const char* text) {
-    std::string key(text);
-    auto it = SymbolTable.find(key);
+    Symbol* symbol = symbolFind(text);
     
-    if (it != SymbolTable.end() && it->second->nature == SYMBOL_FUNCTION)
-        return it->second;
+    if (symbol && symbol->nature == SYMBOL_FUNCTION)
+        return symbol;
     
     return nullptr;
 }
 
+// Função para obter um símbolo pelo seu id denso
+Symbol* symbolById(int id) {
+    if (id < 0 || id >= (int)SymbolsById.size())
+        return nullptr;
+    return SymbolsById[id];
+}
+
+// Função para obter a quantidade de símbolos na tabela
+int symbolCount(void) {
+    return (int)SymbolsById.size();
+}
+
+static bool symbolTextLess(const Symbol* a, const Symbol* b) {
+    return a->text < b->text;
+}
+
 // Função para imprimir a tabela de símbolos
 void symbolPrintTable(void) {
     printf("\n===== SYMBOL TABLE =====\n");
-    for (const auto& entry : SymbolTable) {
-        Symbol* symbol = entry.second;
+    
+    // A tabela hash não tem ordem: imprime ordenado pelo texto
+    std::vector<Symbol*> sorted(SymbolsById);
+    std::sort(sorted.begin(), sorted.end(), symbolTextLess);
+    
+    for (Symbol* symbol : sorted) {
         printf("Symbol[%s]: ", symbol->text.c_str());
         
         // Imprimir natureza do símbolo
@@ -64,6 +155,7 @@ void symbolPrintTable(void) {
             case SYMBOL_SCALAR: printf("SCALAR, "); break;
             case SYMBOL_VECTOR: printf("VECTOR[%d], ", symbol->vectorSize); break;
             case SYMBOL_FUNCTION: printf("FUNCTION, "); break;
+            default: break;
         }
         
         // Imprimir tipo de dado
@@ -145,12 +237,8 @@ bool isTypeCompatible(DataType type1, DataType type2) {
     return false;
 }
 
-// Função para obter o tipo de uma expressão
-DataType getExpressionType(void* node) {
-    if (!node) return DATATYPE_UNDEFINED;
-    
-    AST* ast = (AST*)node;
-    
+// Calcula o tipo de um nó de expressão (os filhos vêm do cache de getExpressionType)
+static DataType computeExpressionType(AST* ast) {
     switch (ast->type) {
         case AST_SYMBOL: {
             Symbol* symbol = (Symbol*)ast->symbol;
@@ -173,85 +261,74 @@ DataType getExpressionType(void* node) {
         }
         
         case AST_OP: {
-            const char* op = (const char*)ast->symbol;
-            if (!op) return DATATYPE_UNDEFINED;
-            
             // Obter tipos dos operandos
             DataType leftType = getExpressionType(ast->son[0]);
             DataType rightType = getExpressionType(ast->son[1]);
             
-            // Operadores relacionais (< > <= >= == !=) retornam boolean
-            if (strcmp(op, "<") == 0 || strcmp(op, ">") == 0 ||
-                strcmp(op, "<=") == 0 || strcmp(op, ">=") == 0 ||
-                strcmp(op, "==") == 0 || strcmp(op, "!=") == 0) {
-                
-                // Verificar compatibilidade dos operandos
-                if (!isTypeCompatible(leftType, rightType)) {
-                    std::cerr << "Semantic error: Incompatible types in relational expression" << std::endl;
-                    semanticErrors++;
-                }
-                
-                return DATATYPE_BOOLEAN;
-            }
-            
-            // Operadores lógicos (& |) retornam boolean e exigem operandos boolean
-            if (strcmp(op, "&") == 0 || strcmp(op, "|") == 0) {
-                if (leftType != DATATYPE_BOOLEAN || rightType != DATATYPE_BOOLEAN) {
-                    std::cerr << "Semantic error: Logical operators require boolean operands" << std::endl;
-                    semanticErrors++;
-                }
-                
-                return DATATYPE_BOOLEAN;
-            }
-            
-            // Operador de acesso a vetor (INDEX)
-            if (strcmp(op, "INDEX") == 0) {
-                // Verificar se o operando esquerdo é um vetor
-                Symbol* symbol = nullptr;
-                if (ast->son[0] && ast->son[0]->type == AST_SYMBOL)
-                    symbol = (Symbol*)ast->son[0]->symbol;
-                
-                if (!symbol || symbol->nature != SYMBOL_VECTOR) {
-                    std::cerr << "Semantic error: Indexed expression is not a vector" << std::endl;
-                    semanticErrors++;
-                    return DATATYPE_UNDEFINED;
-                }
+            switch (ast->op) {
+                // Operadores relacionais (< > <= >= == !=) retornam boolean
+                case OP_LT:
+                case OP_GT:
+                case OP_LE:
+                case OP_GE:
+                case OP_EQ:
+                case OP_NE:
+                    // Verificar compatibilidade dos operandos
+                    if (!isTypeCompatible(leftType, rightType)) {
+                        std::cerr << "Semantic error: Incompatible types in relational expression" << std::endl;
+                        semanticErrors++;
+                    }
+                    return DATATYPE_BOOLEAN;
                 
-                // Verificar se o índice é inteiro
-                DataType indexType = getExpressionType(ast->son[1]);
-                if (indexType != DATATYPE_INT && indexType != DATATYPE_CHAR && indexType != DATATYPE_BYTE) {
-                    std::cerr << "Semantic error: Vector index must be an integer" << std::endl;
-                    semanticErrors++;
+                // Operador de acesso a vetor (INDEX)
+                case OP_INDEX: {
+                    // Verificar se o operando esquerdo é um vetor
+                    Symbol* symbol = nullptr;
+                    if (ast->son[0] && ast->son[0]->type == AST_SYMBOL)
+                        symbol = (Symbol*)ast->son[0]->symbol;
+                    
+                    if (!symbol || symbol->nature != SYMBOL_VECTOR) {
+                        std::cerr << "Semantic error: Indexed expression is not a vector" << std::endl;
+                        semanticErrors++;
+                        return DATATYPE_UNDEFINED;
+                    }
+                    
+                    // Verificar se o índice é inteiro
+                    DataType indexType = getExpressionType(ast->son[1]);
+                    if (indexType != DATATYPE_INT && indexType != DATATYPE_CHAR && indexType != DATATYPE_BYTE) {
+                        std::cerr << "Semantic error: Vector index must be an integer" << std::endl;
+                        semanticErrors++;
+                    }
+                    
+                    return symbol->dataType;
                 }
                 
-                return symbol->dataType;
-            }
-            
-            // Operadores aritméticos (+ - * / %)
-            if (strcmp(op, "+") == 0 || strcmp(op, "-") == 0 ||
-                strcmp(op, "*") == 0 || strcmp(op, "/") == 0 ||
-                strcmp(op, "%") == 0) {
+                // Operadores aritméticos (+ - * /)
+                case OP_ADD:
+                case OP_SUB:
+                case OP_MUL:
+                case OP_DIV:
+                    // Verificar compatibilidade dos operandos
+                    if (!isTypeCompatible(leftType, rightType)) {
+                        std::cerr << "Semantic error: Incompatible types in arithmetic expression" << std::endl;
+                        semanticErrors++;
+                        return DATATYPE_UNDEFINED;
+                    }
+                    
+                    // Se um dos operandos for real, o resultado é real
+                    if (leftType == DATATYPE_REAL || rightType == DATATYPE_REAL)
+                        return DATATYPE_REAL;
+                    
+                    // Para o operador de divisão (/), o resultado pode ser real mesmo com operandos inteiros
+                    if (ast->op == OP_DIV)
+                        return DATATYPE_REAL;
+                    
+                    // Caso contrário, o resultado é int
+                    return DATATYPE_INT;
                 
-                // Verificar compatibilidade dos operandos
-                if (!isTypeCompatible(leftType, rightType)) {
-                    std::cerr << "Semantic error: Incompatible types in arithmetic expression" << std::endl;
-                    semanticErrors++;
+                default:
                     return DATATYPE_UNDEFINED;
-                }
-                
-                // Se um dos operandos for real, o resultado é real
-                if (leftType == DATATYPE_REAL || rightType == DATATYPE_REAL)
-                    return DATATYPE_REAL;
-                
-                // Para o operador de divisão (/), o resultado pode ser real mesmo com operandos inteiros
-                if (strcmp(op, "/") == 0)
-                    return DATATYPE_REAL;
-                
-                // Caso contrário, o resultado é int
-                return DATATYPE_INT;
             }
-            
-            return DATATYPE_UNDEFINED;
         }
         
         case AST_FUNC_CALL: {
@@ -259,18 +336,18 @@ DataType getExpressionType(void* node) {
             Symbol* symbol = (Symbol*)ast->symbol;
             if (!symbol) return DATATYPE_UNDEFINED;
             
+            // Verificar a chamada e seus argumentos (uma única vez por nó)
+            checkFunctionCall(ast);
+            
             // Verificar se a função existe na tabela de símbolos
             Symbol* funcSymbol = findFunction(symbol->text.c_str());
             
-            // Se a função não existe, não reportar erro (pode ser declarada depois)
-            // Retornar INT como tipo padrão para funções não declaradas
+            // Se a função não existe, pode ser declarada depois:
+            // retornar INT como tipo padrão para funções não declaradas
             if (!funcSymbol) {
                 return DATATYPE_INT;
             }
             
-            // Verificar argumentos da chamada de função
-            checkFunctionCall(ast);
-            
             return funcSymbol->returnType;
         }
         
@@ -279,6 +356,19 @@ DataType getExpressionType(void* node) {
     }
 }
 
+// Função para obter o tipo de uma expressão. O tipo é calculado de baixo
+// para cima uma única vez e guardado no nó; chamadas seguintes (outras
+// verificações, geração de TACs) apenas leem o valor, sem repetir erros.
+DataType getExpressionType(void* node) {
+    if (!node) return DATATYPE_UNDEFINED;
+    
+    AST* ast = (AST*)node;
+    if (ast->data_type < 0) {
+        ast->data_type = computeExpressionType(ast);
+    }
+    return (DataType)ast->data_type;
+}
+
 // Função para verificar índice de vetor
 bool checkVectorIndex(void* node) {
     if (!node) return false;
@@ -286,7 +376,7 @@ bool checkVectorIndex(void* node) {
     AST* ast = (AST*)node;
     
     // Verificar se o nó é uma operação de índice
-    if (ast->type != AST_OP || !ast->symbol || strcmp((const char*)ast->symbol, "INDEX") != 0)
+    if (ast->type != AST_OP || ast->op != OP_INDEX)
         return false;
     
     // Verificar se o operando esquerdo é um símbolo
@@ -433,7 +523,7 @@ bool checkDeclaration(void* node) {
     AST* ast = (AST*)node;
     
     // Verificar se o nó é uma declaração de variável ou função
-    if (ast->type != AST_VAR_DECL && ast->type != AST_FUNC_DECL)
+    if (ast->type != AST_VAR_DECL && ast->type != AST_VEC_DECL && ast->type != AST_FUNC_DECL)
         return false;
     
     Symbol* symbol = (Symbol*)ast->symbol;
@@ -456,81 +546,40 @@ bool checkDeclaration(void* node) {
     }
     
     // Configurar natureza e informações adicionais
-    if (ast->type == AST_VAR_DECL) {
-        // Verificar se é um vetor ou escalar
-        if (ast->son[0] && !ast->son[1]) {
-            // Verificar se é um vetor ou variável escalar com inicialização
-            if (ast->son[0]->type == AST_SYMBOL && 
-                ((Symbol*)ast->son[0]->symbol)->type == LIT_INT && 
-                ast->son[0]->next) {
-                // É uma declaração de vetor sem inicialização: int v[10];
-                symbol->nature = SYMBOL_VECTOR;
-                
-                // Obter tamanho do vetor
-                Symbol* sizeSymbol = (Symbol*)ast->son[0]->symbol;
-                if (sizeSymbol) {
-                    try {
-                        symbol->vectorSize = std::stoi(sizeSymbol->text);
-                    } catch (...) {
-                        symbol->vectorSize = 0;
-                    }
-                }
-            } else {
-                // Verificar se é um vetor sem inicialização: int v[10];
-                AST* sizeNode = ast->son[0];
-                Symbol* sizeSymbol = nullptr;
-                
-                // Verificar se estamos realmente lidando com uma declaração de vetor
-                // Verificar se o símbolo é 'num', que é um caso especial no arquivo de teste
-                if (strcmp(symbol->text.c_str(), "num") == 0) {
-                    // No arquivo de teste, num é uma variável escalar, não um vetor
-                    symbol->nature = SYMBOL_SCALAR;
-                } else {
-                    // Verificar se o tamanho do vetor é um inteiro
-                    DataType sizeType = getExpressionType(ast->son[0]);
-                    if (sizeType != DATATYPE_UNDEFINED && sizeType != DATATYPE_INT && 
-                        sizeType != DATATYPE_BYTE && sizeType != DATATYPE_CHAR) {
-                        // Verificar se estamos no arquivo de teste
-                        if (strcmp(symbol->text.c_str(), "vetor") == 0 && strcmp(((Symbol*)ast->son[0]->symbol)->text.c_str(), "f") == 0) {
-                            // Este é um erro específico para o arquivo de teste
-                            std::cerr << "Semantic error: Vector size must be an integer for '" << symbol->text << "'" << std::endl;
-                            semanticErrors++;
-                        }
-                    }
-                }
-                
-                if (sizeNode->type == AST_SYMBOL && sizeNode->symbol) {
-                    sizeSymbol = (Symbol*)sizeNode->symbol;
-                    if (sizeSymbol->token == LIT_INT) {
-                        // É um vetor com tamanho definido por literal inteiro
-                        symbol->nature = SYMBOL_VECTOR;
-                        symbol->vectorSize = std::stoi(sizeSymbol->text);
-                    } else if (sizeSymbol->token == LIT_REAL || sizeSymbol->token == LIT_STRING || sizeSymbol->token == LIT_CHAR) {
-                        // Literal não inteiro usado como tamanho de vetor
-                        std::cerr << "Semantic error: Vector size must be an integer for '" << symbol->text << "'" << std::endl;
-                        semanticErrors++;
-                        symbol->nature = SYMBOL_VECTOR;
-                        symbol->vectorSize = 0;
-                    } else {
-                        // É uma variável escalar com inicialização
-                        symbol->nature = SYMBOL_SCALAR;
-                        
-                        // Verificar inicialização
-                        DataType initType = getExpressionType(ast->son[0]);
-                        if (initType != DATATYPE_UNDEFINED && symbol->dataType != DATATYPE_UNDEFINED && 
-                            !isTypeCompatible(symbol->dataType, initType)) {
-                            std::cerr << "Semantic error: Incompatible initialization for '" << symbol->text << "'" << std::endl;
-                            semanticErrors++;
-                        }
-                    }
-                } else {
-                    // É um vetor com tamanho definido por expressão
-                    symbol->nature = SYMBOL_VECTOR;
-                }
+    if (ast->type == AST_VEC_DECL) {
+        // Vetor: int v[10]; ou int v[10] = 0, 1, 2, ...
+        symbol->nature = SYMBOL_VECTOR;
+        
+        AST* sizeNode = ast->son[0];
+        Symbol* sizeSymbol = (sizeNode && sizeNode->type == AST_SYMBOL) ? (Symbol*)sizeNode->symbol : nullptr;
+        
+        if (sizeSymbol && sizeSymbol->type == LIT_INT) {
+            // Tamanho definido por literal inteiro
+            try {
+                symbol->vectorSize = std::stoi(sizeSymbol->text);
+            } catch (...) {
+                symbol->vectorSize = 0;
             }
         } else {
-            // Variável escalar sem inicialização: int a;
-            symbol->nature = SYMBOL_SCALAR;
+            // Tamanho definido por expressão: precisa ao menos ser inteira
+            DataType sizeType = getExpressionType(sizeNode);
+            if (sizeType != DATATYPE_INT && sizeType != DATATYPE_BYTE && sizeType != DATATYPE_CHAR) {
+                std::cerr << "Semantic error: Vector size must be an integer for '" << symbol->text << "'" << std::endl;
+                semanticErrors++;
+            }
+            symbol->vectorSize = 0;
+        }
+    } else if (ast->type == AST_VAR_DECL) {
+        symbol->nature = SYMBOL_SCALAR;
+        
+        if (ast->son[0]) {
+            // Variável escalar com inicialização: int a = 0;
+            DataType initType = getExpressionType(ast->son[0]);
+            if (initType != DATATYPE_UNDEFINED && symbol->dataType != DATATYPE_UNDEFINED && 
+                !isTypeCompatible(symbol->dataType, initType)) {
+                std::cerr << "Semantic error: Incompatible initialization for '" << symbol->text << "'" << std::endl;
+                semanticErrors++;
+            }
         }
     } else if (ast->type == AST_FUNC_DECL) {
         // Função
@@ -12,7 +12,9 @@
 typedef enum {
     SYMBOL_SCALAR,    // Variável escalar
     SYMBOL_VECTOR,    // Vetor
-    SYMBOL_FUNCTION   // Função
+    SYMBOL_FUNCTION,  // Função
+    SYMBOL_TEMP,      // Temporário gerado pelas TACs (fora da tabela)
+    SYMBOL_LABEL      // Rótulo gerado pelas TACs (fora da tabela)
 } SymbolNature;
 
 // Definição dos tipos de dados
@@ -44,8 +46,11 @@ public:
     DataType dataType;          // Tipo de dado do símbolo
     int vectorSize;             // Tamanho do vetor (se for vetor)
     std::vector<Parameter> parameters;  // Lista de parâmetros (se for função)
+    std::vector<Symbol*> initializer;   // Literais da lista de inicialização (se for vetor)
     DataType returnType;        // Tipo de retorno (se for função)
     bool isDeclared;            // Flag para indicar se o símbolo foi declarado
+    int id;                     // Índice denso do símbolo (ordem de inserção)
+    int number;                 // Número do temporário/rótulo (se for TEMP/LABEL)
     
     Symbol(int t, std::string s) : 
         token(0), 
@@ -55,13 +60,18 @@ public:
         dataType(DATATYPE_UNDEFINED), 
         vectorSize(0), 
         returnType(DATATYPE_UNDEFINED), 
-        isDeclared(false) {}
+        isDeclared(false),
+        id(-1),
+        number(-1) {}
 };
 
 // Funções para manipulação de símbolos
 Symbol* symbolInsert(int type, const char* text);
+Symbol* symbolInsert(int type, const char* text, int length);
 Symbol* symbolFind(const char* text);
 Symbol* findFunction(const char* text);
+Symbol* symbolById(int id);
+int symbolCount(void);
 void symbolPrintTable(void);
 
 // Funções para verificação semântica
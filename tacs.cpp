@@ -5,28 +5,44 @@
 #include "tacs.hpp"
 #include "ast.h"
 #include "symbols.hpp"
+#include "parser.tab.hpp"
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <deque>
 
-// Contador para temporários e labels
-static int temp_count = 0;
-static int label_count = 0;
+// Temporários e labels: alocados em blocos (endereços estáveis), sem nome
+// em memória e sem entrada na tabela de símbolos global
+static std::deque<Symbol> temp_pool;
+static std::deque<Symbol> label_pool;
 
 // Funções para criar símbolos temporários e labels
-char* makeTemp() {
-    char* temp = (char*)malloc(16);
-    sprintf(temp, "_temp%d", temp_count++);
+Symbol* makeTemp(DataType dataType) {
+    temp_pool.emplace_back(0, std::string());
+    Symbol* temp = &temp_pool.back();
+    temp->nature = SYMBOL_TEMP;
+    temp->dataType = dataType;
+    temp->number = (int)temp_pool.size() - 1;
     return temp;
 }
 
-char* makeLabel() {
-    char* label = (char*)malloc(16);
-    sprintf(label, "_label%d", label_count++);
+Symbol* makeLabel(void) {
+    label_pool.emplace_back(0, std::string());
+    Symbol* label = &label_pool.back();
+    label->nature = SYMBOL_LABEL;
+    label->number = (int)label_pool.size() - 1;
     return label;
 }
 
+int tacTempCount(void) {
+    return (int)temp_pool.size();
+}
+
+int tacLabelCount(void) {
+    return (int)label_pool.size();
+}
+
 // Função para criar uma TAC
 TAC* tacCreate(TacType type, void* res, void* op1, void* op2) {
     TAC* tac = (TAC*)malloc(sizeof(TAC));
@@ -34,6 +50,8 @@ TAC* tacCreate(TacType type, void* res, void* op1, void* op2) {
     tac->res = res;
     tac->op1 = op1;
     tac->op2 = op2;
+    tac->inBounds = false;
+    tac->kernel = NULL;
     tac->prev = NULL;
     tac->next = NULL;
     return tac;
@@ -59,6 +77,188 @@ TAC* tacJoin(TAC* l1, TAC* l2) {
     return l1;
 }
 
+// Retira a TAC da lista e a libera; devolve a TAC seguinte
+TAC* tacRemove(TAC* tac) {
+    TAC* next = tac->next;
+    if (tac->prev) tac->prev->next = next;
+    if (next) next->prev = tac->prev;
+    free(tac);
+    return next;
+}
+
+// Operandos definidos e usados pela TAC (base da análise de vida e dos
+// intervalos da alocação de registradores)
+TacOperands tacOperands(TAC* tac) {
+    TacOperands ops;
+    ops.def = NULL;
+    ops.use[0] = ops.use[1] = ops.use[2] = NULL;
+    ops.usesGlobals = false;
+
+    switch (tac->type) {
+        case TAC_MOVE:
+            ops.def = (Symbol*)tac->res;
+            ops.use[0] = (Symbol*)tac->op1;
+            break;
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MUL:
+        case TAC_DIV:
+        case TAC_LT:
+        case TAC_GT:
+        case TAC_LE:
+        case TAC_GE:
+        case TAC_EQ:
+        case TAC_NE:
+        case TAC_VECTOR_INDEX:
+        case TAC_VECTOR_ADDRESS:
+        case TAC_POINTER_LOAD:
+            ops.def = (Symbol*)tac->res;
+            ops.use[0] = (Symbol*)tac->op1;
+            ops.use[1] = (Symbol*)tac->op2;
+            break;
+        case TAC_VECTOR_ASSIGN:
+        case TAC_POINTER_STORE:
+            // Escrita parcial: o vetor continua vivo
+            ops.use[0] = (Symbol*)tac->res;
+            ops.use[1] = (Symbol*)tac->op1;
+            ops.use[2] = (Symbol*)tac->op2;
+            break;
+        case TAC_VECTOR_INIT:
+            ops.use[0] = (Symbol*)tac->res;
+            break;
+        case TAC_SIMD_LOOP:
+            // Lê e avança a variável de indução; o limite é lido
+            ops.def = (Symbol*)tac->res;
+            ops.use[0] = (Symbol*)tac->res;
+            ops.use[1] = (Symbol*)tac->op1;
+            break;
+        case TAC_IFZ:
+        case TAC_ARG:
+        case TAC_PRINT:
+            ops.use[0] = (Symbol*)tac->op1;
+            break;
+        case TAC_IFNLT:
+        case TAC_IFNGT:
+        case TAC_IFNLE:
+        case TAC_IFNGE:
+        case TAC_IFNEQ:
+        case TAC_IFNNE:
+            ops.use[0] = (Symbol*)tac->op1;
+            ops.use[1] = (Symbol*)tac->op2;
+            break;
+        case TAC_READ:
+            ops.def = (Symbol*)tac->res;
+            break;
+        case TAC_CALL:
+            ops.def = (Symbol*)tac->res;
+            ops.usesGlobals = true;
+            break;
+        case TAC_RET:
+            ops.use[0] = (Symbol*)tac->op1;
+            ops.usesGlobals = true;
+            break;
+        case TAC_ENDFUN:
+            ops.usesGlobals = true;
+            break;
+        default:
+            break;
+    }
+    return ops;
+}
+
+// Campos da TAC lidos como escalares (o vetor das TACs de vetor fica de
+// fora). Devolve quantos
+int tacUseFields(TAC* tac, void** fields[2]) {
+    switch (tac->type) {
+        case TAC_MOVE:
+        case TAC_IFZ:
+        case TAC_ARG:
+        case TAC_PRINT:
+        case TAC_RET:
+        case TAC_SIMD_LOOP:
+            fields[0] = &tac->op1;
+            return 1;
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MUL:
+        case TAC_DIV:
+        case TAC_LT:
+        case TAC_GT:
+        case TAC_LE:
+        case TAC_GE:
+        case TAC_EQ:
+        case TAC_NE:
+        case TAC_VECTOR_ASSIGN:
+        case TAC_IFNLT:
+        case TAC_IFNGT:
+        case TAC_IFNLE:
+        case TAC_IFNGE:
+        case TAC_IFNEQ:
+        case TAC_IFNNE:
+            fields[0] = &tac->op1;
+            fields[1] = &tac->op2;
+            return 2;
+        case TAC_VECTOR_INDEX:
+        case TAC_VECTOR_ADDRESS:
+            fields[0] = &tac->op2;
+            return 1;
+        case TAC_POINTER_LOAD:
+            fields[0] = &tac->op1;
+            return 1;
+        case TAC_POINTER_STORE:
+            fields[0] = &tac->res;
+            fields[1] = &tac->op1;
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+// Desvio condicional: IFZ ou uma comparação com desvio (label em res)
+bool tacIsConditionalJump(const TAC* tac) {
+    return tac->type == TAC_IFZ || (tac->type >= TAC_IFNLT && tac->type <= TAC_IFNNE);
+}
+
+// Sequência vazia
+TacList tacListEmpty(void) {
+    TacList list;
+    list.head = NULL;
+    list.tail = NULL;
+    return list;
+}
+
+// Sequência com uma única TAC
+TacList tacListOf(TAC* tac) {
+    TacList list;
+    list.head = tac;
+    list.tail = tac;
+    return list;
+}
+
+// Junta duas sequências em O(1): o fim de l1 passa a apontar para o início de l2
+TacList tacListJoin(TacList l1, TacList l2) {
+    if (!l1.head) return l2;
+    if (!l2.head) return l1;
+    
+    l1.tail->next = l2.head;
+    l2.head->prev = l1.tail;
+    
+    TacList list;
+    list.head = l1.head;
+    list.tail = l2.tail;
+    return list;
+}
+
+// Anexa uma TAC ao fim da sequência
+void tacListAppend(TacList* list, TAC* tac) {
+    *list = tacListJoin(*list, tacListOf(tac));
+}
+
+// Operando que guarda o resultado da sequência (destino da última TAC)
+void* tacListRes(TacList list) {
+    return list.tail ? list.tail->res : NULL;
+}
+
 // Função auxiliar para imprimir um símbolo de forma segura
 void printSymbol(void* symbol) {
     if (!symbol) {
@@ -67,7 +267,12 @@ void printSymbol(void* symbol) {
     }
     
     Symbol* sym = (Symbol*)symbol;
-    printf("%s", sym->text.c_str());
+    if (sym->nature == SYMBOL_TEMP)
+        printf("_temp%d", sym->number);
+    else if (sym->nature == SYMBOL_LABEL)
+        printf("_label%d", sym->number);
+    else
+        printf("%s", sym->text.c_str());
 }
 
 // Função para imprimir uma TAC
@@ -149,6 +354,39 @@ void tacPrint(TAC* tac) {
         case TAC_VECTOR_ASSIGN:
             printf("VECTOR_ASSIGN");
             break;
+        case TAC_VECTOR_ADDRESS:
+            printf("VECTOR_ADDRESS");
+            break;
+        case TAC_POINTER_LOAD:
+            printf("POINTER_LOAD");
+            break;
+        case TAC_POINTER_STORE:
+            printf("POINTER_STORE");
+            break;
+        case TAC_VECTOR_INIT:
+            printf("VECTOR_INIT");
+            break;
+        case TAC_SIMD_LOOP:
+            printf("SIMD_LOOP");
+            break;
+        case TAC_IFNLT:
+            printf("IFNLT");
+            break;
+        case TAC_IFNGT:
+            printf("IFNGT");
+            break;
+        case TAC_IFNLE:
+            printf("IFNLE");
+            break;
+        case TAC_IFNGE:
+            printf("IFNGE");
+            break;
+        case TAC_IFNEQ:
+            printf("IFNEQ");
+            break;
+        case TAC_IFNNE:
+            printf("IFNNE");
+            break;
         default:
             printf("UNKNOWN");
     }
@@ -163,6 +401,12 @@ void tacPrint(TAC* tac) {
     printSymbol(tac->op2);
     
     printf(")\n");
+
+    // Kernel do laço vetorizado, recuado
+    for (TAC* step = tac->kernel; step; step = step->next) {
+        printf("    ");
+        tacPrint(step);
+    }
 }
 
 // Função para imprimir uma lista de TACs de trás para frente
@@ -185,593 +429,350 @@ void tacPrintBackwards(TAC* tac) {
 
 // Função para imprimir uma lista de TACs para frente
 void tacPrintForward(TAC* tac) {
-    if (!tac) return;
-    tacPrint(tac);
-    tacPrintForward(tac->next);
+    for (; tac; tac = tac->next) {
+        tacPrint(tac);
+    }
 }
 
 // Funções auxiliares para geração de código
 
+// TAC correspondente a cada operador da AST, indexada por AstOperator
+static const TacType opTacType[OP_COUNT] = {
+    TAC_ADD,            // OP_NONE (não ocorre)
+    TAC_ADD,            // OP_ADD
+    TAC_SUB,            // OP_SUB
+    TAC_MUL,            // OP_MUL
+    TAC_DIV,            // OP_DIV
+    TAC_LT,             // OP_LT
+    TAC_GT,             // OP_GT
+    TAC_LE,             // OP_LE
+    TAC_GE,             // OP_GE
+    TAC_EQ,             // OP_EQ
+    TAC_NE,             // OP_NE
+    TAC_VECTOR_INDEX    // OP_INDEX
+};
+
+// Código já gerado para os filhos de um nó. A geração percorre a AST em
+// pós-ordem com a travessia iterativa (astWalkNext): cada nó deixa uma
+// sequência na pilha de resultados e, ao sair de um nó, as sequências dos
+// seus filhos estão no topo, em ordem (son[0] e irmãos, son[1] e irmãos, ...)
+typedef struct {
+    TacList* items;   // sequências de cada nó filho, em ordem
+    int start[5];     // índice em items do primeiro nó de son[i] (start[4] = total)
+} SonCode;
+
+// Sequência do k-ésimo nó da lista son[i] (vazia se não existir)
+static TacList sonItem(const SonCode* sons, int i, int k) {
+    if (sons->start[i] + k >= sons->start[i + 1]) return tacListEmpty();
+    return sons->items[sons->start[i] + k];
+}
+
+// Quantidade de nós na lista son[i]
+static int sonCount(const SonCode* sons, int i) {
+    return sons->start[i + 1] - sons->start[i];
+}
+
+// Sequências de todos os nós da lista son[i], juntas
+static TacList sonList(const SonCode* sons, int i) {
+    TacList code = tacListEmpty();
+    for (int k = sons->start[i]; k < sons->start[i + 1]; k++) {
+        code = tacListJoin(code, sons->items[k]);
+    }
+    return code;
+}
+
 // Gera código para expressões
-TAC* generateCodeExpr(AST* node) {
-    if (!node) return NULL;
-    
+static TacList generateCodeExpr(AST* node, const SonCode* sons) {
     // Caso base: símbolo (variável ou literal)
     if (node->type == AST_SYMBOL) {
-        return tacCreate(TAC_SYMBOL, node->symbol, NULL, NULL);
-    }
-    
-    // Caso para acesso a vetor: a[i]
-    if (node->type == AST_OP && strcmp((char*)node->symbol, "INDEX") == 0) {
-        TAC* index = generateCode(node->son[1]);
-        TAC* vector = generateCode(node->son[0]);
-        
-        Symbol* temp = symbolInsert(0, makeTemp());
-        temp->dataType = ((Symbol*)node->son[0]->symbol)->dataType;
-        
-        TAC* vectorIndex = tacCreate(TAC_VECTOR_INDEX, temp, vector->res, index->res);
-        return tacJoin(tacJoin(index, vector), vectorIndex);
+        return tacListOf(tacCreate(TAC_SYMBOL, node->symbol, NULL, NULL));
     }
     
     // Caso para chamada de função
     if (node->type == AST_FUNC_CALL) {
-        TAC* args = NULL;
-        AST* arg = node->son[0];
-        int argCount = 0;
+        TacList code = tacListEmpty();
         
         // Processa argumentos
-        while (arg) {
-            TAC* argCode = generateCode(arg);
-            TAC* argTac = tacCreate(TAC_ARG, NULL, argCode->res, NULL);
-            args = tacJoin(args, tacJoin(argCode, argTac));
-            arg = arg->next;
-            argCount++;
+        for (int k = 0; k < sonCount(sons, 0); k++) {
+            TacList argCode = sonItem(sons, 0, k);
+            code = tacListJoin(code, argCode);
+            tacListAppend(&code, tacCreate(TAC_ARG, NULL, tacListRes(argCode), NULL));
         }
         
         // Cria temporário para resultado
-        Symbol* temp = symbolInsert(0, makeTemp());
         Symbol* funcSymbol = (Symbol*)node->symbol;
-        temp->dataType = funcSymbol->returnType;
+        Symbol* temp = makeTemp(funcSymbol->returnType);
         
         // Cria TAC de chamada
-        TAC* call = tacCreate(TAC_CALL, temp, node->symbol, NULL);
-        return tacJoin(args, call);
+        tacListAppend(&code, tacCreate(TAC_CALL, temp, node->symbol, NULL));
+        return code;
     }
     
-    // Caso para operações binárias
-    if (node->type == AST_OP) {
-        TAC* code0 = generateCode(node->son[0]);
-        TAC* code1 = generateCode(node->son[1]);
-        
-        Symbol* temp = symbolInsert(0, makeTemp());
-        temp->dataType = getExpressionType(node);
-        
-        TacType opType;
-        char* op = (char*)node->symbol;
-        
-        if (strcmp(op, "+") == 0) opType = TAC_ADD;
-        else if (strcmp(op, "-") == 0) opType = TAC_SUB;
-        else if (strcmp(op, "*") == 0) opType = TAC_MUL;
-        else if (strcmp(op, "/") == 0) opType = TAC_DIV;
-        else if (strcmp(op, "<") == 0 || 
-                 strcmp(op, ">") == 0 || 
-                 strcmp(op, "<=") == 0 || 
-                 strcmp(op, ">=") == 0 || 
-                 strcmp(op, "==") == 0 || 
-                 strcmp(op, "!=") == 0) {
-            // Para operações relacionais, usamos o mesmo TAC_ADD mas com o operador armazenado
-            opType = TAC_ADD;
-            // Aqui poderíamos criar TACs específicos para cada operação relacional se necessário
-        } else {
-            opType = TAC_ADD; // Default
+    TacList code0 = sonItem(sons, 0, 0);
+    TacList code1 = sonItem(sons, 1, 0);
+    
+    // Criar um símbolo temporário para o resultado, com o tipo calculado na análise semântica
+    Symbol* temp = makeTemp(node->data_type >= 0 ? (DataType)node->data_type : DATATYPE_UNDEFINED);
+    
+    // Determinar o tipo de operação
+    TacType opType = opTacType[node->op];
+    if (node->op == OP_INDEX) {
+        // Caso especial para acesso a vetor: a[i]
+        if (node->son[0] && node->son[0]->symbol) {
+            temp->dataType = ((Symbol*)node->son[0]->symbol)->dataType;
         }
-        
-        TAC* opTac = tacCreate(opType, temp, code0->res, code1->res);
-        return tacJoin(tacJoin(code0, code1), opTac);
     }
     
-    return NULL;
+    TAC* opTac = tacCreate(opType, temp, tacListRes(code0), tacListRes(code1));
+    TacList code = tacListJoin(code0, code1);
+    tacListAppend(&code, opTac);
+    return code;
 }
 
 // Gera código para comandos
-TAC* generateCodeCmd(AST* node) {
-    if (!node) return NULL;
+static TacList generateCodeCmd(AST* node, const SonCode* sons) {
+    TacList code = tacListEmpty();
     
     switch (node->type) {
         case AST_IF: {
-            TAC* codeExpr = generateCode(node->son[0]);
-            TAC* codeCmd = generateCode(node->son[1]);
+            TacList codeExpr = sonItem(sons, 0, 0);
+            TacList codeCmd = sonList(sons, 1);
             
-            char* labelEnd = makeLabel();
-            Symbol* labelSymbol = symbolInsert(0, labelEnd);
+            Symbol* labelSymbol = makeLabel();
             
-            TAC* jumpIfz = tacCreate(TAC_IFZ, labelSymbol, codeExpr->res, NULL);
-            TAC* labelTac = tacCreate(TAC_LABEL, labelSymbol, NULL, NULL);
-            
-            return tacJoin(tacJoin(tacJoin(codeExpr, jumpIfz), codeCmd), labelTac);
+            code = codeExpr;
+            tacListAppend(&code, tacCreate(TAC_IFZ, labelSymbol, tacListRes(codeExpr), NULL));
+            code = tacListJoin(code, codeCmd);
+            tacListAppend(&code, tacCreate(TAC_LABEL, labelSymbol, NULL, NULL));
+            return code;
         }
         
         case AST_IF_ELSE: {
-            TAC* codeExpr = generateCode(node->son[0]);
-            TAC* codeThen = generateCode(node->son[1]);
-            TAC* codeElse = generateCode(node->son[2]);
-            
-            char* labelElse = makeLabel();
-            char* labelEnd = makeLabel();
-            
-            Symbol* labelElseSymbol = symbolInsert(0, labelElse);
-            Symbol* labelEndSymbol = symbolInsert(0, labelEnd);
-            
-            TAC* jumpIfz = tacCreate(TAC_IFZ, labelElseSymbol, codeExpr->res, NULL);
-            TAC* jumpEnd = tacCreate(TAC_JUMP, labelEndSymbol, NULL, NULL);
-            TAC* labelElseTac = tacCreate(TAC_LABEL, labelElseSymbol, NULL, NULL);
-            TAC* labelEndTac = tacCreate(TAC_LABEL, labelEndSymbol, NULL, NULL);
-            
-            return tacJoin(tacJoin(tacJoin(tacJoin(tacJoin(tacJoin(
-                codeExpr, jumpIfz), codeThen), jumpEnd), labelElseTac), codeElse), labelEndTac);
+            TacList codeExpr = sonItem(sons, 0, 0);
+            TacList codeThen = sonList(sons, 1);
+            TacList codeElse = sonList(sons, 2);
+            
+            Symbol* labelElseSymbol = makeLabel();
+            Symbol* labelEndSymbol = makeLabel();
+            
+            code = codeExpr;
+            tacListAppend(&code, tacCreate(TAC_IFZ, labelElseSymbol, tacListRes(codeExpr), NULL));
+            code = tacListJoin(code, codeThen);
+            tacListAppend(&code, tacCreate(TAC_JUMP, labelEndSymbol, NULL, NULL));
+            tacListAppend(&code, tacCreate(TAC_LABEL, labelElseSymbol, NULL, NULL));
+            code = tacListJoin(code, codeElse);
+            tacListAppend(&code, tacCreate(TAC_LABEL, labelEndSymbol, NULL, NULL));
+            return code;
         }
         
         case AST_WHILE: {
-            TAC* codeExpr = generateCode(node->son[0]);
-            TAC* codeCmd = generateCode(node->son[1]);
-            
-            char* labelBegin = makeLabel();
-            char* labelEnd = makeLabel();
-            
-            Symbol* labelBeginSymbol = symbolInsert(0, labelBegin);
-            Symbol* labelEndSymbol = symbolInsert(0, labelEnd);
-            
-            TAC* labelBeginTac = tacCreate(TAC_LABEL, labelBeginSymbol, NULL, NULL);
-            TAC* jumpIfz = tacCreate(TAC_IFZ, labelEndSymbol, codeExpr->res, NULL);
-            TAC* jumpBegin = tacCreate(TAC_JUMP, labelBeginSymbol, NULL, NULL);
-            TAC* labelEndTac = tacCreate(TAC_LABEL, labelEndSymbol, NULL, NULL);
-            
-            return tacJoin(tacJoin(tacJoin(tacJoin(tacJoin(
-                labelBeginTac, codeExpr), jumpIfz), codeCmd), jumpBegin), labelEndTac);
+            TacList codeExpr = sonItem(sons, 0, 0);
+            TacList codeCmd = sonList(sons, 1);
+            
+            Symbol* labelBeginSymbol = makeLabel();
+            Symbol* labelEndSymbol = makeLabel();
+            
+            code = tacListOf(tacCreate(TAC_LABEL, labelBeginSymbol, NULL, NULL));
+            code = tacListJoin(code, codeExpr);
+            tacListAppend(&code, tacCreate(TAC_IFZ, labelEndSymbol, tacListRes(codeExpr), NULL));
+            code = tacListJoin(code, codeCmd);
+            tacListAppend(&code, tacCreate(TAC_JUMP, labelBeginSymbol, NULL, NULL));
+            tacListAppend(&code, tacCreate(TAC_LABEL, labelEndSymbol, NULL, NULL));
+            return code;
         }
         
         case AST_DO_WHILE: {
-            TAC* codeCmd = generateCode(node->son[0]);
-            TAC* codeExpr = generateCode(node->son[1]);
-            
-            char* labelBegin = makeLabel();
+            TacList codeCmd = sonList(sons, 0);
+            TacList codeExpr = sonItem(sons, 1, 0);
             
-            Symbol* labelBeginSymbol = symbolInsert(0, labelBegin);
+            Symbol* labelBeginSymbol = makeLabel();
+            Symbol* labelEndSymbol = makeLabel();
             
-            TAC* labelBeginTac = tacCreate(TAC_LABEL, labelBeginSymbol, NULL, NULL);
-            TAC* jumpIfz = tacCreate(TAC_IFZ, labelBeginSymbol, codeExpr->res, NULL);
-            
-            return tacJoin(tacJoin(tacJoin(
-                labelBeginTac, codeCmd), codeExpr), jumpIfz);
+            // Para do-while: primeiro executamos o corpo, depois testamos a condição
+            code = tacListOf(tacCreate(TAC_LABEL, labelBeginSymbol, NULL, NULL));
+            code = tacListJoin(code, codeCmd);
+            code = tacListJoin(code, codeExpr);
+            // Se a condição for falsa (zero), sai do loop; senão volta ao início
+            tacListAppend(&code, tacCreate(TAC_IFZ, labelEndSymbol, tacListRes(codeExpr), NULL));
+            tacListAppend(&code, tacCreate(TAC_JUMP, labelBeginSymbol, NULL, NULL));
+            tacListAppend(&code, tacCreate(TAC_LABEL, labelEndSymbol, NULL, NULL));
+            return code;
         }
         
         case AST_ASSIGN: {
             // Atribuição simples: a = expr
             if (!node->son[1]) {
-                TAC* codeExpr = generateCode(node->son[0]);
-                TAC* move = tacCreate(TAC_MOVE, node->symbol, codeExpr->res, NULL);
-                return tacJoin(codeExpr, move);
+                code = sonItem(sons, 0, 0);
+                tacListAppend(&code, tacCreate(TAC_MOVE, node->symbol, tacListRes(code), NULL));
+                return code;
             }
             // Atribuição a vetor: a[expr1] = expr2
-            else {
-                TAC* codeIndex = generateCode(node->son[0]);
-                TAC* codeExpr = generateCode(node->son[1]);
-                TAC* vectorAssign = tacCreate(TAC_VECTOR_ASSIGN, node->symbol, codeIndex->res, codeExpr->res);
-                return tacJoin(tacJoin(codeIndex, codeExpr), vectorAssign);
-            }
+            TacList codeIndex = sonItem(sons, 0, 0);
+            TacList codeExpr = sonItem(sons, 1, 0);
+            code = tacListJoin(codeIndex, codeExpr);
+            tacListAppend(&code, tacCreate(TAC_VECTOR_ASSIGN, node->symbol,
+                                           tacListRes(codeIndex), tacListRes(codeExpr)));
+            return code;
         }
         
-        case AST_READ: {
-            TAC* read = tacCreate(TAC_READ, node->symbol, NULL, NULL);
-            return read;
-        }
+        case AST_READ:
+            return tacListOf(tacCreate(TAC_READ, node->symbol, NULL, NULL));
         
         case AST_PRINT: {
-            TAC* codePrint = NULL;
-            AST* expr = node->son[0];
-            
             // Processa cada expressão na lista
-            while (expr) {
-                TAC* codeExpr = generateCode(expr);
-                TAC* print = tacCreate(TAC_PRINT, NULL, codeExpr->res, NULL);
-                codePrint = tacJoin(tacJoin(codePrint, codeExpr), print);
-                expr = expr->next;
+            for (int k = 0; k < sonCount(sons, 0); k++) {
+                TacList codeExpr = sonItem(sons, 0, k);
+                code = tacListJoin(code, codeExpr);
+                tacListAppend(&code, tacCreate(TAC_PRINT, NULL, tacListRes(codeExpr), NULL));
             }
-            
-            return codePrint;
+            return code;
         }
         
         case AST_RETURN: {
-            TAC* codeExpr = generateCode(node->son[0]);
-            TAC* ret = tacCreate(TAC_RET, NULL, codeExpr->res, NULL);
-            return tacJoin(codeExpr, ret);
+            code = sonItem(sons, 0, 0);
+            tacListAppend(&code, tacCreate(TAC_RET, NULL, tacListRes(code), NULL));
+            return code;
         }
         
-        case AST_BLOCK: {
-            return generateCode(node->son[0]); // Gera código para a lista de comandos
-        }
+        case AST_BLOCK:
+            return sonList(sons, 0); // Código da lista de comandos
         
         default:
-            return generateCode(node->son[0]); // Caso padrão, tenta gerar código para o primeiro filho
+            return sonList(sons, 0); // Caso padrão, usa o código do primeiro filho
     }
 }
 
 // Gera código para declarações
-TAC* generateCodeDecl(AST* node) {
-    if (!node) return NULL;
+static TacList generateCodeDecl(AST* node, const SonCode* sons) {
+    TacList code = tacListEmpty();
     
     switch (node->type) {
         case AST_VAR_DECL: {
             // Declaração simples: tipo id;
             if (!node->son[0]) {
-                return NULL; // Não gera código para declaração simples
+                return code; // Não gera código para declaração simples
             }
             // Declaração com inicialização: tipo id = expr;
-            else if (!node->son[1]) {
-                TAC* codeExpr = generateCode(node->son[0]);
-                TAC* move = tacCreate(TAC_MOVE, node->symbol, codeExpr->res, NULL);
-                return tacJoin(codeExpr, move);
-            }
-            // Declaração de vetor com inicialização: tipo id[expr] = {expr1, expr2, ...};
-            else {
-                TAC* codeSize = generateCode(node->son[0]);
-                TAC* codeInit = NULL;
-                
-                // Processa a lista de inicialização
-                AST* init = node->son[1];
-                int index = 0;
-                
-                while (init) {
-                    TAC* codeExpr = generateCode(init);
-                    
-                    // Cria um símbolo para o índice
-                    char indexStr[16];
-                    sprintf(indexStr, "%d", index);
-                    Symbol* indexSymbol = symbolInsert(0, strdup(indexStr));
-                    
-                    TAC* vectorAssign = tacCreate(TAC_VECTOR_ASSIGN, node->symbol, indexSymbol, codeExpr->res);
-                    codeInit = tacJoin(tacJoin(codeInit, codeExpr), vectorAssign);
-                    
-                    init = init->next;
-                    index++;
-                }
-                
-                return tacJoin(codeSize, codeInit);
+            code = sonItem(sons, 0, 0);
+            tacListAppend(&code, tacCreate(TAC_MOVE, node->symbol, tacListRes(code), NULL));
+            return code;
+        }
+        
+        case AST_VEC_DECL: {
+            // Declaração de vetor: tipo id[expr]; o tamanho é estático, só a
+            // lista de inicialização (tipo id[expr] = lit1, lit2, ...;) gera
+            // código: os literais ficam no símbolo e uma única TAC os copia
+            // (o backend coloca a lista direto na seção de dados)
+            if (!node->son[1]) return code;
+            Symbol* vector = (Symbol*)node->symbol;
+            vector->initializer.clear();
+            for (AST* literal = node->son[1]; literal; literal = literal->next) {
+                vector->initializer.push_back((Symbol*)literal->symbol);
             }
+            return tacListOf(tacCreate(TAC_VECTOR_INIT, vector, NULL, NULL));
         }
         
         case AST_FUNC_DECL: {
-            TAC* codeParams = NULL;
-            TAC* codeBlock = generateCode(node->son[1]); // Gera código para o bloco
+            TacList codeBlock = sonList(sons, 1); // Código do bloco (son[0] são os parâmetros)
             
-            // Cria TACs para início e fim de função
-            TAC* beginFunc = tacCreate(TAC_BEGINFUN, node->symbol, NULL, NULL);
-            TAC* endFunc = tacCreate(TAC_ENDFUN, node->symbol, NULL, NULL);
-            
-            // Junta tudo
-            return tacJoin(tacJoin(tacJoin(beginFunc, codeParams), codeBlock), endFunc);
+            // Cria TACs para início e fim de função e junta tudo
+            code = tacListOf(tacCreate(TAC_BEGINFUN, node->symbol, NULL, NULL));
+            code = tacListJoin(code, codeBlock);
+            tacListAppend(&code, tacCreate(TAC_ENDFUN, node->symbol, NULL, NULL));
+            return code;
         }
         
         default:
-            return NULL;
+            return code;
     }
 }
 
-// Função principal para gerar código a partir da AST
-TAC* generateCode(void* node) {
-    if (!node) return NULL;
-    
-    AST* ast = (AST*)node;
-    
-    // Debug: imprimir o tipo do nó que estamos processando (comentado para produção)
-    // fprintf(stderr, "Generating code for node type %d\n", ast->type);
-    
-    // Processar nós irmãos (next) primeiro para garantir que todos os nós sejam processados
-    TAC* nextCode = NULL;
-    if (ast->next) {
-        nextCode = generateCode(ast->next);
-    }
-    
-    TAC* code = NULL;
-    
-    switch (ast->type) {
+// Gera código para um único nó a partir do código dos filhos
+static TacList generateCodeNode(AST* node, const SonCode* sons) {
+    switch (node->type) {
         // Expressões
         case AST_SYMBOL:
-            // Para símbolos, criamos uma TAC simples
-            code = tacCreate(TAC_SYMBOL, ast->symbol, NULL, NULL);
-            return tacJoin(code, nextCode);
-            
-        case AST_OP: {
-            // Para operações, geramos código para os operandos e depois para a operação
-            TAC* code0 = NULL;
-            TAC* code1 = NULL;
-            
-            if (ast->son[0]) code0 = generateCode(ast->son[0]);
-            if (ast->son[1]) code1 = generateCode(ast->son[1]);
-            
-            // Criar um símbolo temporário para o resultado
-            Symbol* temp = symbolInsert(0, makeTemp());
-            
-            // Determinar o tipo de operação
-            TacType opType = TAC_ADD; // Default
-            char* op = (char*)ast->symbol;
-            
-            if (strcmp(op, "+") == 0) opType = TAC_ADD;
-            else if (strcmp(op, "-") == 0) opType = TAC_SUB;
-            else if (strcmp(op, "*") == 0) opType = TAC_MUL;
-            else if (strcmp(op, "/") == 0) opType = TAC_DIV;
-            else if (strcmp(op, "<") == 0) opType = TAC_LT;
-            else if (strcmp(op, ">") == 0) opType = TAC_GT;
-            else if (strcmp(op, "<=") == 0) opType = TAC_LE;
-            else if (strcmp(op, ">=") == 0) opType = TAC_GE;
-            else if (strcmp(op, "==") == 0) opType = TAC_EQ;
-            else if (strcmp(op, "!=") == 0) opType = TAC_NE;
-            else if (strcmp(op, "INDEX") == 0) {
-                // Caso especial para acesso a vetor
-                TAC* vectorIndex = tacCreate(TAC_VECTOR_INDEX, temp, 
-                                           code0 ? code0->res : NULL, 
-                                           code1 ? code1->res : NULL);
-                code = tacJoin(tacJoin(code0, code1), vectorIndex);
-                return tacJoin(code, nextCode);
-            }
-            
-            // Criar TAC para a operação
-            TAC* opTac = tacCreate(opType, temp, 
-                                 code0 ? code0->res : NULL, 
-                                 code1 ? code1->res : NULL);
-            
-            code = tacJoin(tacJoin(code0, code1), opTac);
-            return tacJoin(code, nextCode);
-        }
-            
-        case AST_FUNC_CALL: {
-            // Para chamadas de função, geramos código para os argumentos
-            TAC* args = NULL;
-            AST* arg = ast->son[0];
-            
-            // Processar argumentos
-            while (arg) {
-                TAC* argCode = generateCode(arg);
-                TAC* argTac = tacCreate(TAC_ARG, NULL, argCode ? argCode->res : NULL, NULL);
-                args = tacJoin(tacJoin(args, argCode), argTac);
-                arg = arg->next;
-            }
-            
-            // Criar temporário para resultado
-            char* tempName = makeTemp();
-            Symbol* temp = symbolInsert(0, tempName);
-            
-            // Criar TAC para chamada de função
-            TAC* call = tacCreate(TAC_CALL, temp, ast->symbol, NULL);
-            code = tacJoin(args, call);
-            return tacJoin(code, nextCode);
-        }
+        case AST_OP:
+        case AST_FUNC_CALL:
+            return generateCodeExpr(node, sons);
         
         // Comandos
-        case AST_IF: {
-            TAC* codeExpr = generateCode(ast->son[0]);
-            TAC* codeCmd = generateCode(ast->son[1]);
-            
-            char* labelEnd = makeLabel();
-            Symbol* labelSymbol = symbolInsert(0, labelEnd);
-            
-            TAC* jumpIfz = tacCreate(TAC_IFZ, labelSymbol, 
-                                   codeExpr ? codeExpr->res : NULL, NULL);
-            TAC* labelTac = tacCreate(TAC_LABEL, labelSymbol, NULL, NULL);
-            
-            code = tacJoin(tacJoin(tacJoin(codeExpr, jumpIfz), codeCmd), labelTac);
-            return tacJoin(code, nextCode);
-        }
-        
-        case AST_IF_ELSE: {
-            TAC* codeExpr = generateCode(ast->son[0]);
-            TAC* codeThen = generateCode(ast->son[1]);
-            TAC* codeElse = generateCode(ast->son[2]);
-            
-            char* labelElse = makeLabel();
-            char* labelEnd = makeLabel();
-            
-            Symbol* labelElseSymbol = symbolInsert(0, labelElse);
-            Symbol* labelEndSymbol = symbolInsert(0, labelEnd);
-            
-            TAC* jumpIfz = tacCreate(TAC_IFZ, labelElseSymbol, 
-                                   codeExpr ? codeExpr->res : NULL, NULL);
-            TAC* jumpEnd = tacCreate(TAC_JUMP, labelEndSymbol, NULL, NULL);
-            TAC* labelElseTac = tacCreate(TAC_LABEL, labelElseSymbol, NULL, NULL);
-            TAC* labelEndTac = tacCreate(TAC_LABEL, labelEndSymbol, NULL, NULL);
-            
-            return tacJoin(tacJoin(tacJoin(tacJoin(tacJoin(tacJoin(
-                codeExpr, jumpIfz), codeThen), jumpEnd), labelElseTac), codeElse), labelEndTac);
-        }
-        
-        case AST_WHILE: {
-            TAC* codeExpr = generateCode(ast->son[0]);
-            TAC* codeCmd = generateCode(ast->son[1]);
-            
-            char* labelBegin = makeLabel();
-            char* labelEnd = makeLabel();
-            
-            Symbol* labelBeginSymbol = symbolInsert(0, labelBegin);
-            Symbol* labelEndSymbol = symbolInsert(0, labelEnd);
-            
-            TAC* labelBeginTac = tacCreate(TAC_LABEL, labelBeginSymbol, NULL, NULL);
-            TAC* jumpIfz = tacCreate(TAC_IFZ, labelEndSymbol, 
-                                   codeExpr ? codeExpr->res : NULL, NULL);
-            TAC* jumpBegin = tacCreate(TAC_JUMP, labelBeginSymbol, NULL, NULL);
-            TAC* labelEndTac = tacCreate(TAC_LABEL, labelEndSymbol, NULL, NULL);
-            
-            return tacJoin(tacJoin(tacJoin(tacJoin(tacJoin(
-                labelBeginTac, codeExpr), jumpIfz), codeCmd), jumpBegin), labelEndTac);
-        }
-        
-        case AST_DO_WHILE: {
-            TAC* codeCmd = generateCode(ast->son[0]);
-            TAC* codeExpr = generateCode(ast->son[1]);
-            
-            char* labelBegin = makeLabel();
-            char* labelEnd = makeLabel();
-            
-            Symbol* labelBeginSymbol = symbolInsert(0, labelBegin);
-            Symbol* labelEndSymbol = symbolInsert(0, labelEnd);
-            
-            TAC* labelBeginTac = tacCreate(TAC_LABEL, labelBeginSymbol, NULL, NULL);
-            // Se a condição for falsa (zero), sai do loop
-            TAC* jumpIfz = tacCreate(TAC_IFZ, labelEndSymbol, 
-                                    codeExpr ? codeExpr->res : NULL, NULL);
-            // Se a condição for verdadeira, volta ao início
-            TAC* jumpBegin = tacCreate(TAC_JUMP, labelBeginSymbol, NULL, NULL);
-            TAC* labelEndTac = tacCreate(TAC_LABEL, labelEndSymbol, NULL, NULL);
-            
-            // Para do-while: primeiro executamos o corpo, depois testamos a condição
-            code = tacJoin(tacJoin(tacJoin(tacJoin(tacJoin(
-                labelBeginTac, codeCmd), codeExpr), jumpIfz), jumpBegin), labelEndTac);
-            return tacJoin(code, nextCode);
-        }
-        
-        case AST_ASSIGN: {
-            // Verificar se é atribuição simples ou a vetor
-            if (ast->son[1]) {
-                // Atribuição a vetor: id[expr1] = expr2
-                TAC* codeIndex = generateCode(ast->son[0]);
-                TAC* codeExpr = generateCode(ast->son[1]);
-                
-                TAC* vectorAssign = tacCreate(TAC_VECTOR_ASSIGN, ast->symbol, 
-                                           codeIndex ? codeIndex->res : NULL, 
-                                           codeExpr ? codeExpr->res : NULL);
-                
-                code = tacJoin(tacJoin(codeIndex, codeExpr), vectorAssign);
-                return tacJoin(code, nextCode);
-            } else {
-                // Atribuição simples: id = expr
-                TAC* codeExpr = generateCode(ast->son[0]);
-                
-                TAC* move = tacCreate(TAC_MOVE, ast->symbol, 
-                                   codeExpr ? codeExpr->res : NULL, NULL);
-                
-                code = tacJoin(codeExpr, move);
-                return tacJoin(code, nextCode);
-            }
-        }
-        
-        case AST_READ: {
-            code = tacCreate(TAC_READ, ast->symbol, NULL, NULL);
-            return tacJoin(code, nextCode);
-        }
-        
-        case AST_PRINT: {
-            TAC* codePrint = NULL;
-            AST* expr = ast->son[0];
-            
-            // Processar cada expressão na lista
-            while (expr) {
-                TAC* codeExpr = generateCode(expr);
-                TAC* print = tacCreate(TAC_PRINT, NULL, 
-                                     codeExpr ? codeExpr->res : NULL, NULL);
-                
-                codePrint = tacJoin(tacJoin(codePrint, codeExpr), print);
-                expr = expr->next;
-            }
-            
-            return tacJoin(codePrint, nextCode);
-        }
-        
-        case AST_RETURN: {
-            TAC* codeExpr = generateCode(ast->son[0]);
-            
-            TAC* ret = tacCreate(TAC_RET, NULL, 
-                                codeExpr ? codeExpr->res : NULL, NULL);
-            
-            code = tacJoin(codeExpr, ret);
-            return tacJoin(code, nextCode);
-        }
-        
-        case AST_BLOCK: {
-            // Gerar código para a lista de comandos
-            code = generateCode(ast->son[0]);
-            return tacJoin(code, nextCode);
-        }
+        case AST_IF:
+        case AST_IF_ELSE:
+        case AST_WHILE:
+        case AST_DO_WHILE:
+        case AST_ASSIGN:
+        case AST_READ:
+        case AST_PRINT:
+        case AST_RETURN:
+        case AST_BLOCK:
+            return generateCodeCmd(node, sons);
         
         // Declarações
-        case AST_VAR_DECL: {
-            // Declaração com inicialização
-            if (ast->son[0]) {
-                if (ast->son[1]) {
-                    // Declaração de vetor com inicialização: tipo id[expr] = {expr1, expr2, ...};
-                    TAC* codeSize = generateCode(ast->son[0]);
-                    TAC* codeInit = NULL;
-                    
-                    // Processar lista de inicialização
-                    AST* init = ast->son[1];
-                    int index = 0;
-                    
-                    while (init) {
-                        TAC* codeExpr = generateCode(init);
-                        
-                        // Criar símbolo para o índice
-                        char indexStr[16];
-                        sprintf(indexStr, "%d", index);
-                        Symbol* indexSymbol = symbolInsert(0, strdup(indexStr));
-                        
-                        TAC* vectorAssign = tacCreate(TAC_VECTOR_ASSIGN, ast->symbol, 
-                                                   indexSymbol, 
-                                                   codeExpr ? codeExpr->res : NULL);
-                        
-                        codeInit = tacJoin(tacJoin(codeInit, codeExpr), vectorAssign);
-                        
-                        init = init->next;
-                        index++;
-                    }
-                    
-                    code = tacJoin(codeSize, codeInit);
-                    return tacJoin(code, nextCode);
-                } else {
-                    // Declaração com inicialização: tipo id = expr;
-                    TAC* codeExpr = generateCode(ast->son[0]);
-                    
-                    TAC* move = tacCreate(TAC_MOVE, ast->symbol, 
-                                       codeExpr ? codeExpr->res : NULL, NULL);
-                    
-                    code = tacJoin(codeExpr, move);
-                    return tacJoin(code, nextCode);
-                }
-            }
-            // Declaração simples: tipo id;
-            return nextCode;
-        }
+        case AST_VAR_DECL:
+        case AST_VEC_DECL:
+        case AST_FUNC_DECL:
+            return generateCodeDecl(node, sons);
         
-        case AST_FUNC_DECL: {
-            // Gerar código para o bloco da função
-            TAC* codeBlock = generateCode(ast->son[1]);
-            
-            // Criar TACs para início e fim de função
-            TAC* beginFunc = tacCreate(TAC_BEGINFUN, ast->symbol, NULL, NULL);
-            TAC* endFunc = tacCreate(TAC_ENDFUN, ast->symbol, NULL, NULL);
-            
-            code = tacJoin(tacJoin(beginFunc, codeBlock), endFunc);
-            return tacJoin(code, nextCode);
-        }
+        // Parâmetros não geram código
+        case AST_PARAM_LIST:
+            return tacListEmpty();
         
-        // Listas
+        // Listas: junta o código de todos os filhos
         case AST_PROGRAMA:
         case AST_DECL_LIST:
         case AST_CMD_LIST:
-        case AST_EXPR_LIST:
-        case AST_PARAM_LIST: {
-            TAC* code = NULL;
-            
-            // Processar filhos
+        case AST_EXPR_LIST: {
+            TacList code = tacListEmpty();
             for (int i = 0; i < 4; i++) {
-                if (ast->son[i]) {
-                    TAC* sonCode = generateCode(ast->son[i]);
-                    code = tacJoin(code, sonCode);
-                }
+                code = tacListJoin(code, sonList(sons, i));
             }
-            
-            return tacJoin(code, nextCode);
+            return code;
         }
         
         default:
-            fprintf(stderr, "Warning: Unhandled AST node type %d in generateCode\n", ast->type);
-            return nextCode;
+            fprintf(stderr, "Warning: Unhandled AST node type %d in generateCode\n", node->type);
+            return tacListEmpty();
+    }
+}
+
+// Função principal para gerar código a partir da AST (o nó e seus irmãos)
+TAC* generateCode(void* node) {
+    std::vector<TacList> results;  // pilha de resultados dos nós já visitados
+    AstWalker walker;
+    AstStep step;
+    
+    astWalkBegin(&walker, (AST*)node);
+    while (astWalkNext(&walker, &step)) {
+        if (!step.post) continue;
+        
+        // Localiza no topo da pilha os resultados dos filhos de cada son[i]
+        AST* ast = step.node;
+        int counts[4];
+        int total = 0;
+        for (int i = 0; i < 4; i++) {
+            counts[i] = 0;
+            for (AST* son = ast->son[i]; son; son = son->next) counts[i]++;
+            total += counts[i];
+        }
+        
+        int base = (int)results.size() - total;
+        SonCode sons;
+        sons.items = results.data() + base;
+        sons.start[0] = 0;
+        for (int i = 0; i < 4; i++) {
+            sons.start[i + 1] = sons.start[i] + counts[i];
+        }
+        
+        TacList code = generateCodeNode(ast, &sons);
+        results.resize(base);
+        results.push_back(code);
+    }
+    
+    // Restam na pilha os resultados do nó inicial e de seus irmãos
+    TacList code = tacListEmpty();
+    for (size_t k = 0; k < results.size(); k++) {
+        code = tacListJoin(code, results[k]);
     }
+    return code.head;
 }
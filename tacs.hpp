@@ -7,6 +7,7 @@
 
 #include <string>
 #include <vector>
+#include "symbols.hpp"
 
 // Tipos de operações para TACs
 typedef enum {
@@ -33,29 +34,69 @@ typedef enum {
     TAC_PRINT,      // Impressão: print a
     TAC_READ,       // Leitura: read a
     TAC_VECTOR_INDEX, // Acesso a vetor: a = b[c]
-    TAC_VECTOR_ASSIGN // Atribuição a vetor: a[b] = c
+    TAC_VECTOR_ASSIGN, // Atribuição a vetor: a[b] = c
+    TAC_VECTOR_ADDRESS, // Endereço de elemento: a = &b[c]
+    TAC_POINTER_LOAD,  // Leitura por ponteiro: a = *b (elemento do vetor c)
+    TAC_POINTER_STORE, // Escrita por ponteiro: *a = b (elemento do vetor c)
+    TAC_IFNLT,      // Se não b < c: goto a (comparação e desvio juntos)
+    TAC_IFNGT,      // Se não b > c: goto a
+    TAC_IFNLE,      // Se não b <= c: goto a
+    TAC_IFNGE,      // Se não b >= c: goto a
+    TAC_IFNEQ,      // Se não b == c: goto a
+    TAC_IFNNE,      // Se não b != c: goto a
+    TAC_VECTOR_INIT, // Inicialização de vetor: a[0..] = literais de a->initializer
+    TAC_SIMD_LOOP   // Laço vetorizado: avança a até perto de b rodando kernel em blocos
 } TacType;
 
 // Estrutura para representar uma TAC
 typedef struct tac_node {
     TacType type;
+    bool inBounds;      // VECTOR_INDEX/ASSIGN com índice provado nos limites (sem verificação)
     void* res;
     void* op1;
     void* op2;
+    struct tac_node* kernel; // SIMD_LOOP: TACs de uma iteração do laço (fora da lista)
     struct tac_node* prev;
     struct tac_node* next;
 } TAC;
 
+// Sequência de TACs: guarda início e fim para juntar e anexar em O(1)
+typedef struct tac_list {
+    TAC* head;
+    TAC* tail;
+} TacList;
+
+// Operandos definidos e usados por uma TAC
+typedef struct {
+    Symbol* def;
+    Symbol* use[3];
+    bool usesGlobals;           // CALL, RET e ENDFUN: qualquer variável pode ser lida
+} TacOperands;
+
 // Funções para criar e manipular TACs
 TAC* tacCreate(TacType type, void* res, void* op1, void* op2);
 TAC* tacJoin(TAC* l1, TAC* l2);
+TAC* tacRemove(TAC* tac);
+int tacUseFields(TAC* tac, void** fields[2]);
+TacOperands tacOperands(TAC* tac);
+bool tacIsConditionalJump(const TAC* tac);
+
+// Funções para manipular sequências de TACs
+TacList tacListEmpty(void);
+TacList tacListOf(TAC* tac);
+TacList tacListJoin(TacList l1, TacList l2);
+void tacListAppend(TacList* list, TAC* tac);
+void* tacListRes(TacList list);
 void tacPrint(TAC* tac);
 void tacPrintBackwards(TAC* tac);
 void tacPrintForward(TAC* tac);
 
-// Funções para criar símbolos temporários e labels
-char* makeTemp();
-char* makeLabel();
+// Funções para criar temporários e labels: operandos numerados, fora da
+// tabela de símbolos; o nome só é produzido na impressão
+Symbol* makeTemp(DataType dataType);
+Symbol* makeLabel(void);
+int tacTempCount(void);
+int tacLabelCount(void);
 
 // Função principal para gerar código a partir da AST
 TAC* generateCode(void* node);
@@ -0,0 +1,34 @@
+#!/bin/sh
+# bench.sh - compara o tempo de compilação de um programa gerado
+#
+# Uso: tests/bench.sh modo N compilador [compilador...]
+# Gera "gen modo N" e imprime, para cada compilador, o melhor de BENCH_RUNS
+# tempos de compilação (com as opções de BENCH_FLAGS). Passar o etapa5 de
+# uma versão anterior como segundo compilador mede o antes e depois. Sem -O
+# um programa com erros semânticos (saída 4) também passa por todas as fases
+# até as TACs, então conta como compilado.
+
+GEN=${GEN:-tests/gen}
+RUNS=${BENCH_RUNS:-3}
+TMP=${TMPDIR:-/tmp}/bench.$$
+
+mode=$1
+size=$2
+shift 2
+mkdir -p "$TMP"
+"$GEN" $mode $size > "$TMP/prog.txt" || exit 1
+for compiler in "$@"; do
+    best=""
+    run=0
+    while [ $run -lt $RUNS ]; do
+        start=$(date +%s%N)
+        "$compiler" $BENCH_FLAGS "$TMP/prog.txt" "$TMP/out.txt" > /dev/null 2>&1
+        rc=$?
+        if [ $rc -ne 0 ] && [ $rc -ne 4 ]; then echo "$compiler: compile failed ($rc)"; exit 1; fi
+        ms=$(( ($(date +%s%N) - start) / 1000000 ))
+        if [ -z "$best" ] || [ $ms -lt $best ]; then best=$ms; fi
+        run=$((run + 1))
+    done
+    echo "$compiler $mode $size: ${best} ms"
+done
+rm -rf "$TMP"
@@ -0,0 +1,95 @@
+// gen.cpp - gerador de programas sintéticos para os testes de escala e
+// os benchmarks
+//
+// Uso: gen modo N
+//   long N    função main com N comandos em sequência
+//   nested N  N comandos if, em grupos aninhados NEST_DEPTH níveis (a pilha
+//             do parser do bison não comporta aninhamentos muito maiores)
+//   expr N    N comandos com expressões longas que usam todos os operadores
+//   live N    N variáveis e N ifs numa função só, com as variáveis vivas
+//             entre os blocos (análise de vida em funções grandes)
+//
+// O programa gerado vai para a saída padrão
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NEST_DEPTH 64
+
+// N atribuições seguidas, alternando entre três variáveis
+static void genLong(int n) {
+    printf("int a = 0;\nint b = 1;\nint c = 2;\n\nint main() {\n");
+    for (int k = 0; k < n; k++) {
+        switch (k % 3) {
+            case 0: printf("  a = b + %d;\n", k); break;
+            case 1: printf("  b = c * 2 - a;\n"); break;
+            default: printf("  c = a + b;\n"); break;
+        }
+    }
+    printf("  print a \" \" b \" \" c \"\\n\";\n  return 0;\n}\n");
+}
+
+// N ifs, cada um com uma atribuição antes do próximo nível do grupo
+static void genNested(int n) {
+    printf("int a = 0;\n\nint main() {\n");
+    for (int k = 0; k < n; k += NEST_DEPTH) {
+        int depth = n - k < NEST_DEPTH ? n - k : NEST_DEPTH;
+        for (int d = 0; d < depth; d++) printf("if (a < %d) {\na = a + 1;\n", n);
+        for (int d = 0; d < depth; d++) printf("}\n");
+    }
+    printf("print a \"\\n\";\nreturn 0;\n}\n");
+}
+
+// N comandos, cada um com uma expressão de uns 20 operadores: aritméticos,
+// relacionais e acessos a vetor (a divisão dá real, então só aparece em r).
+// O programa serve para medir a compilação; os valores não são conferidos
+static void genExpr(int n) {
+    printf("int v[16];\nint a = 1;\nint b = 2;\nint c = 3;\nint d = 4;\nreal r = 0.0;\n\nint main() {\n");
+    for (int k = 0; k < n; k++) {
+        if (k % 2 == 0) {
+            printf("  a = ((v[%d] + b * c) - (d * 3 + v[%d])) * ((a - %d) + (c * d - b)) + v[(a + b) - (c + %d)];\n",
+                   k % 16, (k + 5) % 16, k % 7, k % 5);
+        } else if (k % 4 == 1) {
+            printf("  if (((a + b) < (c * d)) == ((v[%d] - a) >= (b * 2))) r = r + (c - v[%d]) / 2;\n",
+                   k % 16, (k + 3) % 16);
+        } else {
+            printf("  if (((c <= d) != (a > %d)) == ((v[%d] * 2) <= (d - c))) c = (c + v[%d]) - 2;\n",
+                   k % 11, k % 16, (k + 9) % 16);
+        }
+    }
+    printf("  print a \" \" b \"\\n\";\n  return 0;\n}\n");
+}
+
+// N variáveis globais e N ifs que leem e escrevem variáveis espalhadas,
+// dentro de um laço (a vida dá a volta pela aresta de retorno): uns 2N
+// blocos, todos com as N variáveis como candidatas a vivas
+static void genLive(int n) {
+    for (int k = 0; k < n; k++) printf("int g%d = %d;\n", k, k);
+    printf("int r = 0;\n\nint main() {\n  while (r < 2) do {\n");
+    for (int k = 0; k < n; k++) {
+        printf("    if (g%d < g%d) g%d = g%d + %d;\n", k, (k * 7 + 1) % n, k, (k + 3) % n, k % 13);
+    }
+    printf("    r = r + 1;\n  }\n  print g0 \" \" g%d \"\\n\";\n  return 0;\n}\n", n - 1);
+}
+
+int main(int argc, char** argv) {
+    int n = argc >= 3 ? atoi(argv[2]) : 0;
+    if (n <= 0) {
+        fprintf(stderr, "Call: gen long|nested|expr|live N\n");
+        return 1;
+    }
+    if (strcmp(argv[1], "long") == 0) {
+        genLong(n);
+    } else if (strcmp(argv[1], "nested") == 0) {
+        genNested(n);
+    } else if (strcmp(argv[1], "expr") == 0) {
+        genExpr(n);
+    } else if (strcmp(argv[1], "live") == 0) {
+        genLive(n);
+    } else {
+        fprintf(stderr, "Unknown mode %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+#!/bin/sh
+# liveness.sh - custo da análise de vida em funções grandes
+#
+# Uso: tests/liveness.sh [compilador] [gerador]
+# Compila com -O -stats programas "gen live N" para N, 2N, 4N e 8N e imprime
+# a linha de estatísticas da análise de vida: tempo somado das chamadas,
+# blocos visitados e o tamanho dos conjuntos da maior função. A memória dos
+# conjuntos cresce com blocos x variáveis; o tempo por palavra visitada
+# (ns/word) mostra se o ponto fixo continua limitado pela memória.
+
+ETAPA5=${1:-./etapa5}
+GEN=${2:-tests/gen}
+N=${LIVENESS_N:-2500}
+TMP=${TMPDIR:-/tmp}/liveness.$$
+
+mkdir -p "$TMP"
+for size in $N $((N * 2)) $((N * 4)) $((N * 8)); do
+    "$GEN" live $size > "$TMP/prog.txt" || exit 1
+    "$ETAPA5" -O -stats "$TMP/prog.txt" "$TMP/out.txt" > /dev/null 2> "$TMP/err.txt" || { echo "live $size: compile failed"; exit 1; }
+    # Liveness: R runs, T ms, V block visits; largest B blocks x O operands, M bytes
+    grep '^Liveness:' "$TMP/err.txt" | awk -v size=$size '{
+        ms = $4; visits = $6; blocks = $10; bytes = $15;
+        words = bytes / (32 * blocks);
+        printf "live %d: %s\n    %.2f ns per visited set word\n", size, substr($0, 11), ms * 1e6 / (visits * words);
+    }'
+done
+rm -rf "$TMP"
@@ -0,0 +1,59 @@
+#!/bin/sh
+# regress.sh - programas de regressão em tests/regress
+#
+# Uso: tests/regress.sh [compilador] [diretório]
+# Cada caso X.txt é compilado sem e com -O, montado com cc e executado com a
+# entrada X.in (se existir). A saída (stdout e stderr) seguida de "exit N"
+# deve ser igual a X.out. Se existir X.stats, cada linha dele deve aparecer
+# (como trecho de linha) no resumo que -O -stats imprime em stderr: é o que
+# garante que o passo testado atuou no caso. Um programa com laços
+# vetorizados roda também sem a detecção de AVX2 (o movb que liga .L_avx2
+# sai do assembly), para cobrir os laços SSE2 em qualquer máquina.
+
+ETAPA5=${1:-./etapa5}
+DIR=${2:-tests/regress}
+CC=${CC:-cc}
+TMP=${TMPDIR:-/tmp}/regress.$$
+status=0
+
+# run binário rótulo: executa o caso e compara com X.out
+run() {
+    "$1" < "$input" > "$TMP/got" 2>&1
+    echo "exit $?" >> "$TMP/got"
+    if cmp -s "$TMP/got" "$DIR/$name.out"; then
+        echo "ok   $2"
+    else
+        echo "FAIL $2"
+        diff "$DIR/$name.out" "$TMP/got"
+        status=1
+    fi
+}
+
+mkdir -p "$TMP"
+for prog in "$DIR"/*.txt; do
+    name=$(basename "$prog" .txt)
+    input=/dev/null
+    [ -f "$DIR/$name.in" ] && input="$DIR/$name.in"
+    for opt in "" -O; do
+        if ! "$ETAPA5" $opt -stats "$prog" "$TMP/dec.txt" "$TMP/out.s" > /dev/null 2> "$TMP/stats" ||
+           ! $CC "$TMP/out.s" -o "$TMP/prog" 2> /dev/null; then
+            echo "FAIL $name $opt: compile failed"
+            status=1
+            continue
+        fi
+        run "$TMP/prog" "$name $opt"
+        if grep -q 'movb $1, .L_avx2' "$TMP/out.s"; then
+            grep -v 'movb $1, .L_avx2' "$TMP/out.s" > "$TMP/sse2.s"
+            $CC "$TMP/sse2.s" -o "$TMP/prog" 2> /dev/null && run "$TMP/prog" "$name $opt sse2"
+        fi
+        [ "$opt" = -O ] && [ -f "$DIR/$name.stats" ] || continue
+        while IFS= read -r line; do
+            if ! grep -qF -- "$line" "$TMP/stats"; then
+                echo "FAIL $name $opt: missing \"$line\""
+                status=1
+            fi
+        done < "$DIR/$name.stats"
+    done
+done
+rm -rf "$TMP"
+exit $status
@@ -0,0 +1,35 @@
+#!/bin/sh
+# scale.sh - tempo de compilação de programas gerados de tamanho crescente
+#
+# Uso: tests/scale.sh [compilador] [gerador]
+# Para cada modo do gerador compila programas de N, 2N, 4N e 8N comandos e
+# imprime o tempo total e por comando. Falha se o custo por comando do maior
+# programa passar de SCALE_LIMIT vezes o do menor (crescimento não linear).
+
+ETAPA5=${1:-./etapa5}
+GEN=${2:-tests/gen}
+N=${SCALE_N:-10000}
+LIMIT=${SCALE_LIMIT:-3}
+TMP=${TMPDIR:-/tmp}/scale.$$
+status=0
+
+mkdir -p "$TMP"
+for mode in long nested; do
+    first=""
+    for size in $N $((N * 2)) $((N * 4)) $((N * 8)); do
+        "$GEN" $mode $size > "$TMP/prog.txt" || exit 1
+        start=$(date +%s%N)
+        "$ETAPA5" "$TMP/prog.txt" "$TMP/out.txt" > /dev/null 2>&1 || { echo "$mode $size: compile failed"; exit 1; }
+        ms=$(( ($(date +%s%N) - start) / 1000000 ))
+        # custo por comando em nanossegundos
+        per=$(( ms * 1000000 / size ))
+        [ -z "$first" ] && first=$per
+        echo "$mode $size: ${ms} ms, ${per} ns/stmt"
+    done
+    if [ $per -gt $((first * LIMIT)) ]; then
+        echo "$mode: per-statement cost grew from ${first} to ${per} ns (limit ${LIMIT}x)"
+        status=1
+    fi
+done
+rm -rf "$TMP"
+exit $status